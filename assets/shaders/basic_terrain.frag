@@ -35,7 +35,7 @@ void main()
     vec2 subTextureSize = vec2(1.0 / 16.0, 1.0 / 16.0); 
     vec2 offset = vec2(ID.x * subTextureSize.x,  (ID.y + 1)* -subTextureSize.y); 
     
-    vec2 atlasUV = UV * subTextureSize + offset;
+    vec2 atlasUV = fract(UV) * subTextureSize + offset;
     
     vec4 full_color = texture(texture_atlas, atlasUV);
     if (full_color.a < 0.1) discard;
@@ -59,5 +59,14 @@ void main()
     if (uv == float(2)) UV = vec2(1,0);
     if (uv == float(1)) UV = vec2(0,1);
     if (uv == float(0)) UV = vec2(0,0);
+
+    // Tiled faces (greedy meshing) can span several blocks, use the position so the texture repeats per block
+    if (uv >= float(4))
+    {
+        int tiledFace = int(attributes.x);
+        if (tiledFace == 0 || tiledFace == 1) UV = pos.zy;  // FACE_LEFT, FACE_RIGHT
+        else if (tiledFace == 2 || tiledFace == 3) UV = pos.xy;  // FACE_FRONT, FACE_BACK
+        else UV = pos.xz;  // FACE_TOP, FACE_BOTTOM
+    }
     ID = vec2(mod(textureID, 16), floor(textureID / 16.f));
 }
@@ -38,7 +38,7 @@ void main() {
     vec2 waveDistortion = waveDistortion1 + waveDistortion2;
 
     // Apply wave distortion to UV coordinates
-    vec2 atlasUV = (UV + waveDistortion) * (subTextureSize * 0.98) + offset + vec2(0.001, -0.001);
+    vec2 atlasUV = fract(UV + waveDistortion) * (subTextureSize * 0.98) + offset + vec2(0.001, -0.001);
 
     vec4 full_color = texture(texture_atlas, atlasUV);
     if (full_color.a < 0.1) discard;
@@ -0,0 +1,17 @@
+#pragma once
+#include <chrono>
+
+// Fastest of a few runs in seconds, the slower ones were held up by something else running on the machine
+template <typename Function>
+double time_best_of(int runs, Function function)
+{
+	double best = 0;
+	for (int i = 0; i < runs; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (i == 0 || time < best) best = time;
+	}
+	return best;
+}
@@ -0,0 +1,71 @@
+#include "gameData.h"
+#include "bench.h"
+#include <cstdio>
+#include <map>
+#include <tuple>
+#include <vector>
+
+// Chunk lookups in the toroidal grid against the std::map keyed by position it replaced. Every loaded chunk
+// looks up itself and its 8 neighbours, the way linking and meshing do, so the chunks on the border miss
+
+const int BENCH_RENDER_DISTANCE = 16;
+const int BENCH_RUNS = 20;
+
+int main()
+{
+	int width = 2 * BENCH_RENDER_DISTANCE;
+	std::vector<Chunk> loaded(width * width);
+
+	ChunkGrid grid;
+	grid.reset(width);
+	std::map<std::tuple<int, int>, Chunk*> map;
+	for (int z = 0; z < width; ++z)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			Chunk* chunk = &loaded[x + z * width];
+			int chunkX = x - BENCH_RENDER_DISTANCE;
+			int chunkZ = z - BENCH_RENDER_DISTANCE;
+			grid.insert(chunkX, chunkZ, chunk);
+			map[{ chunkX, chunkZ }] = chunk;
+		}
+	}
+
+	size_t gridFound = 0;
+	double gridTime = time_best_of(BENCH_RUNS, [&]()
+	{
+		gridFound = 0;
+		for (int z = -BENCH_RENDER_DISTANCE; z < BENCH_RENDER_DISTANCE; ++z)
+		{
+			for (int x = -BENCH_RENDER_DISTANCE; x < BENCH_RENDER_DISTANCE; ++x)
+			{
+				for (int dz = -1; dz <= 1; ++dz)
+				{
+					for (int dx = -1; dx <= 1; ++dx) gridFound += grid.get(x + dx, z + dz) != nullptr;
+				}
+			}
+		}
+	});
+
+	size_t mapFound = 0;
+	double mapTime = time_best_of(BENCH_RUNS, [&]()
+	{
+		mapFound = 0;
+		for (int z = -BENCH_RENDER_DISTANCE; z < BENCH_RENDER_DISTANCE; ++z)
+		{
+			for (int x = -BENCH_RENDER_DISTANCE; x < BENCH_RENDER_DISTANCE; ++x)
+			{
+				for (int dz = -1; dz <= 1; ++dz)
+				{
+					for (int dx = -1; dx <= 1; ++dx) mapFound += map.count({ x + dx, z + dz }) != 0;
+				}
+			}
+		}
+	});
+
+	size_t lookups = (size_t)width * width * 9;
+	std::printf("%zu chunks, %zu lookups, %zu found in the grid and %zu in the map\n", loaded.size(), lookups, gridFound, mapFound);
+	std::printf("Grid %8.2f ns/lookup\n", gridTime * 1e9 / lookups);
+	std::printf("Map  %8.2f ns/lookup, %.1fx the grid\n", mapTime * 1e9 / lookups, mapTime / gridTime);
+	return gridFound == mapFound ? 0 : 1;
+}
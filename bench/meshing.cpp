@@ -0,0 +1,76 @@
+#include "gameData.h"
+#include "MeshBuilder.h"
+#include "TerrainGenerator.h"
+#include "bench.h"
+#include <cstdio>
+#include <vector>
+
+// Time to mesh generated chunks and the vertices it makes, on the sine terrain and on the noise terrain with caves.
+// The per face loop looks at the 6 neighbours of every block, the binary mesher culls whole columns at once with
+// the occupancy masks, and greedy meshing merges the faces left into quads
+
+const int BENCH_RADIUS = 4;
+const int BENCH_RUNS = 5;
+
+static void bench_terrain(TerrainType terrainType, bool enableCaves, MeshBuilder* builder)
+{
+	World world;
+	world.terrainGenerator = create_terrain_generator(terrainType, world.seed);
+	if (enableCaves) world.caveGenerator = create_cave_generator(world.seed);
+	world.biomeMap = create_biome_map(world.seed);
+
+	// Chunks without neighbours, their borders are meshed against air
+	std::vector<ChunkSnapshot> snapshots((2 * BENCH_RADIUS) * (2 * BENCH_RADIUS));
+	Chunk* chunk = new Chunk();
+	size_t count = 0;
+	for (int z = -BENCH_RADIUS; z < BENCH_RADIUS; ++z)
+	{
+		for (int x = -BENCH_RADIUS; x < BENCH_RADIUS; ++x)
+		{
+			chunk->reset();
+			world.generate_chunk_data(chunk, x, z);
+			snapshots[count++].copy_from(*chunk);
+		}
+	}
+	delete chunk;
+
+	const char* terrainNames[TERRAIN_TYPE_COUNT] = { "Sine", "Noise" };
+	std::printf("%s terrain%s, %zu chunks\n", terrainNames[terrainType], enableCaves ? " with caves" : "", count);
+
+	ChunkMeshData meshData;
+	const char* modeNames[MESHING_MODE_COUNT] = { "Per face", "Binary", "Greedy" };
+	double perFaceTime = 0;
+	size_t perFaceVertices = 0;
+	for (int mode = 0; mode < MESHING_MODE_COUNT; ++mode)
+	{
+		size_t vertices = 0;
+		double time = time_best_of(BENCH_RUNS, [&]()
+		{
+			vertices = 0;
+			for (const ChunkSnapshot& snapshot : snapshots)
+			{
+				builder->build(snapshot, (MeshingMode)mode, ALL_MESH_PARTS, ALL_MESH_SECTIONS, meshData);
+				vertices += meshData.vertices.size() + meshData.waterVertices.size() + meshData.transparentVertices.size();
+			}
+		});
+		if (mode == PER_FACE_MESHING)
+		{
+			perFaceTime = time;
+			perFaceVertices = vertices;
+		}
+
+		std::printf("  %-8s %8.1f us/chunk, %6.2fx the per face loop, %9zu vertices, %5.1f%% of the per face loop\n",
+			modeNames[mode], time * 1e6 / count, perFaceTime / time, vertices, vertices * 100.0 / perFaceVertices);
+	}
+
+	world.delete_all();
+}
+
+int main()
+{
+	MeshBuilder* builder = new MeshBuilder();
+	bench_terrain(SINE_TERRAIN, false, builder);
+	bench_terrain(NOISE_TERRAIN, true, builder);
+	delete builder;
+	return 0;
+}
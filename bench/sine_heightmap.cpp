@@ -0,0 +1,83 @@
+#include "TerrainGenerator.h"
+#include "bench.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Sine terrain heightmaps per second with the SIMD kernel, against the per column std::sin loop it replaced
+
+const int BENCH_RADIUS = 16;
+const int BENCH_RUNS = 10;
+
+// The heightmap as it was computed before, 8 sines and cosines for every column
+static void generate_reference_heightmap(int chunkX, int chunkZ, int heights[CHUNK_SIZE * CHUNK_SIZE])
+{
+	for (int z = 0; z < CHUNK_SIZE; ++z)
+	{
+		for (int x = 0; x < CHUNK_SIZE; ++x)
+		{
+			float worldX = (float)(x + chunkX * CHUNK_SIZE);
+			float worldZ = (float)(z + chunkZ * CHUNK_SIZE);
+			float height = std::sin(worldX / 40.0f) * 50.0f + std::sin(worldZ / 50.0f) * 60.0f +
+				std::sin(worldX / 3.0f) * 4.0f + std::sin(worldZ / 3.0f) * 4.0f +
+				std::sin((worldX + 201) / 16.0f) * 5.0f * std::cos((worldZ + 420) / 12.0f) * 5.0f +
+				std::sin((worldX + 469) / 8.0f) * 2.0f * std::cos((worldZ + 690) / 8.0f) * 2.0f;
+			heights[x + z * CHUNK_SIZE] = (int)(std::max(height, -32.0f) + 64.0f);
+		}
+	}
+}
+
+int main()
+{
+	SineTerrainGenerator generator;
+	int heights[CHUNK_SIZE * CHUNK_SIZE];
+	int count = (2 * BENCH_RADIUS) * (2 * BENCH_RADIUS);
+
+	// Summed so the heights are used
+	long long simdSum = 0;
+	double simdTime = time_best_of(BENCH_RUNS, [&]()
+	{
+		simdSum = 0;
+		for (int z = -BENCH_RADIUS; z < BENCH_RADIUS; ++z)
+		{
+			for (int x = -BENCH_RADIUS; x < BENCH_RADIUS; ++x)
+			{
+				generator.generate_heightmap(x, z, heights);
+				for (int height : heights) simdSum += height;
+			}
+		}
+	});
+
+	long long referenceSum = 0;
+	double referenceTime = time_best_of(BENCH_RUNS, [&]()
+	{
+		referenceSum = 0;
+		for (int z = -BENCH_RADIUS; z < BENCH_RADIUS; ++z)
+		{
+			for (int x = -BENCH_RADIUS; x < BENCH_RADIUS; ++x)
+			{
+				generate_reference_heightmap(x, z, heights);
+				for (int height : heights) referenceSum += height;
+			}
+		}
+	});
+
+	// The timings only count if the kernel still matches the formula, to within a block like tests/sine_heightmap.cpp
+	int referenceHeights[CHUNK_SIZE * CHUNK_SIZE];
+	int mismatches = 0;
+	for (int z = -BENCH_RADIUS; z < BENCH_RADIUS; ++z)
+	{
+		for (int x = -BENCH_RADIUS; x < BENCH_RADIUS; ++x)
+		{
+			generator.generate_heightmap(x, z, heights);
+			generate_reference_heightmap(x, z, referenceHeights);
+			for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i) mismatches += std::abs(heights[i] - referenceHeights[i]) > 1;
+		}
+	}
+
+	std::printf("%d chunks, height sums %lld and %lld, %d columns more than a block apart\n", count, simdSum, referenceSum, mismatches);
+	std::printf("SIMD     %10.0f chunks/s\n", count / simdTime);
+	std::printf("std::sin %10.0f chunks/s, the SIMD kernel is %.1fx faster\n", count / referenceTime, referenceTime / simdTime);
+	return mismatches == 0 ? 0 : 1;
+}
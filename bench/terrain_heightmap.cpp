@@ -0,0 +1,47 @@
+#include "TerrainGenerator.h"
+#include "bench.h"
+#include <cstdio>
+
+// Heightmap samples per second of the sine and the noise terrain over the same chunks, one sample per column.
+// The noise terrain takes one gradient noise sample per octave for each of them
+
+const int BENCH_RADIUS = 16;
+const int BENCH_RUNS = 10;
+
+// Seconds to generate the heightmaps of every chunk, the heights are summed so they're used
+static double time_heightmaps(const TerrainGenerator& generator, long long& sum)
+{
+	int heights[CHUNK_SIZE * CHUNK_SIZE];
+	return time_best_of(BENCH_RUNS, [&]()
+	{
+		sum = 0;
+		for (int z = -BENCH_RADIUS; z < BENCH_RADIUS; ++z)
+		{
+			for (int x = -BENCH_RADIUS; x < BENCH_RADIUS; ++x)
+			{
+				generator.generate_heightmap(x, z, heights);
+				for (int height : heights) sum += height;
+			}
+		}
+	});
+}
+
+int main()
+{
+	SineTerrainGenerator sine;
+	NoiseTerrainGenerator noise;
+	noise.seed = 20;
+
+	long long sineSum = 0;
+	long long noiseSum = 0;
+	double sineTime = time_heightmaps(sine, sineSum);
+	double noiseTime = time_heightmaps(noise, noiseSum);
+
+	int count = (2 * BENCH_RADIUS) * (2 * BENCH_RADIUS);
+	double samples = (double)count * CHUNK_SIZE * CHUNK_SIZE;
+	std::printf("%d chunks, height sums %lld (sine) and %lld (noise)\n", count, sineSum, noiseSum);
+	std::printf("Sine  %10.0f chunks/s %10.3g samples/s\n", count / sineTime, samples / sineTime);
+	std::printf("Noise %10.0f chunks/s %10.3g samples/s, %.1fx the sine time, %.3g octave samples/s\n",
+		count / noiseTime, samples / noiseTime, noiseTime / sineTime, samples * noise.octaves / noiseTime);
+	return 0;
+}
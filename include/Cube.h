@@ -1,6 +1,6 @@
 #pragma once
 
-static struct VertexData
+struct VertexData
 {
 	glm::vec3 position;
 	glm::vec3 normal;
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstdint>
+
+// Thin wrappers over the widest SIMD instruction set the build targets, so kernels are written once.
+// Only plain float adds and muls are used (no fma), which keeps the results identical on every path
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LANES_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LANES_SSE2
+#else
+#include <cmath>
+#endif
+
+#if defined(LANES_AVX2)
+
+typedef __m256 Lanes;
+typedef __m256i IntLanes;
+typedef __m256 LaneMask;
+static const int LANE_COUNT = 8;
+
+static inline Lanes lanes_set(float value) { return _mm256_set1_ps(value); }
+static inline Lanes lanes_load(const float* source) { return _mm256_loadu_ps(source); }
+static inline void lanes_store(float* target, Lanes value) { _mm256_storeu_ps(target, value); }
+static inline Lanes lanes_add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+static inline Lanes lanes_sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+static inline Lanes lanes_mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+static inline Lanes lanes_div(Lanes a, Lanes b) { return _mm256_div_ps(a, b); }
+static inline Lanes lanes_min(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+static inline Lanes lanes_max(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+static inline Lanes lanes_round(Lanes a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+static inline Lanes lanes_floor(Lanes a) { return _mm256_floor_ps(a); }
+
+static inline LaneMask lanes_greater(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline Lanes lanes_select(LaneMask mask, Lanes ifSet, Lanes otherwise) { return _mm256_blendv_ps(otherwise, ifSet, mask); }
+
+static inline IntLanes int_lanes_set(int32_t value) { return _mm256_set1_epi32(value); }
+static inline IntLanes lanes_to_int(Lanes a) { return _mm256_cvttps_epi32(a); }
+static inline Lanes int_lanes_to_float(IntLanes a) { return _mm256_cvtepi32_ps(a); }
+static inline void int_lanes_store(int32_t* target, IntLanes value) { _mm256_storeu_si256((__m256i*)target, value); }
+static inline IntLanes int_lanes_add(IntLanes a, IntLanes b) { return _mm256_add_epi32(a, b); }
+static inline IntLanes int_lanes_mul(IntLanes a, IntLanes b) { return _mm256_mullo_epi32(a, b); }
+static inline IntLanes int_lanes_xor(IntLanes a, IntLanes b) { return _mm256_xor_si256(a, b); }
+static inline IntLanes int_lanes_shift_right(IntLanes a, int bits) { return _mm256_srli_epi32(a, bits); }
+// (a & bits) == bits, a lane mask of all ones where that holds
+static inline LaneMask int_lanes_test(IntLanes a, int32_t bits)
+{
+	__m256i bitMask = _mm256_set1_epi32(bits);
+	return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(a, bitMask), bitMask));
+}
+
+#elif defined(LANES_SSE2)
+
+typedef __m128 Lanes;
+typedef __m128i IntLanes;
+typedef __m128 LaneMask;
+static const int LANE_COUNT = 4;
+
+static inline Lanes lanes_set(float value) { return _mm_set1_ps(value); }
+static inline Lanes lanes_load(const float* source) { return _mm_loadu_ps(source); }
+static inline void lanes_store(float* target, Lanes value) { _mm_storeu_ps(target, value); }
+static inline Lanes lanes_add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+static inline Lanes lanes_sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+static inline Lanes lanes_mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+static inline Lanes lanes_div(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+static inline Lanes lanes_min(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+static inline Lanes lanes_max(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+static inline Lanes lanes_round(Lanes a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+
+static inline LaneMask lanes_greater(Lanes a, Lanes b) { return _mm_cmpgt_ps(a, b); }
+static inline Lanes lanes_select(LaneMask mask, Lanes ifSet, Lanes otherwise) { return _mm_or_ps(_mm_and_ps(mask, ifSet), _mm_andnot_ps(mask, otherwise)); }
+
+// SSE2 has no floor, truncate and step down where that rounded up
+static inline Lanes lanes_floor(Lanes a)
+{
+	Lanes truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+	return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+}
+
+static inline IntLanes int_lanes_set(int32_t value) { return _mm_set1_epi32(value); }
+static inline IntLanes lanes_to_int(Lanes a) { return _mm_cvttps_epi32(a); }
+static inline Lanes int_lanes_to_float(IntLanes a) { return _mm_cvtepi32_ps(a); }
+static inline void int_lanes_store(int32_t* target, IntLanes value) { _mm_storeu_si128((__m128i*)target, value); }
+static inline IntLanes int_lanes_add(IntLanes a, IntLanes b) { return _mm_add_epi32(a, b); }
+// SSE2 only multiplies the even lanes, so the odd ones are shifted down and multiplied separately
+static inline IntLanes int_lanes_mul(IntLanes a, IntLanes b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+static inline IntLanes int_lanes_xor(IntLanes a, IntLanes b) { return _mm_xor_si128(a, b); }
+static inline IntLanes int_lanes_shift_right(IntLanes a, int bits) { return _mm_srli_epi32(a, bits); }
+static inline LaneMask int_lanes_test(IntLanes a, int32_t bits)
+{
+	__m128i bitMask = _mm_set1_epi32(bits);
+	return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a, bitMask), bitMask));
+}
+
+#else
+
+typedef float Lanes;
+typedef uint32_t IntLanes;
+typedef bool LaneMask;
+static const int LANE_COUNT = 1;
+
+static inline Lanes lanes_set(float value) { return value; }
+static inline Lanes lanes_load(const float* source) { return *source; }
+static inline void lanes_store(float* target, Lanes value) { *target = value; }
+static inline Lanes lanes_add(Lanes a, Lanes b) { return a + b; }
+static inline Lanes lanes_sub(Lanes a, Lanes b) { return a - b; }
+static inline Lanes lanes_mul(Lanes a, Lanes b) { return a * b; }
+static inline Lanes lanes_div(Lanes a, Lanes b) { return a / b; }
+static inline Lanes lanes_min(Lanes a, Lanes b) { return a < b ? a : b; }
+static inline Lanes lanes_max(Lanes a, Lanes b) { return a > b ? a : b; }
+static inline Lanes lanes_round(Lanes a) { return std::nearbyint(a); }
+static inline Lanes lanes_floor(Lanes a) { return std::floor(a); }
+
+static inline LaneMask lanes_greater(Lanes a, Lanes b) { return a > b; }
+static inline Lanes lanes_select(LaneMask mask, Lanes ifSet, Lanes otherwise) { return mask ? ifSet : otherwise; }
+
+static inline IntLanes int_lanes_set(int32_t value) { return (uint32_t)value; }
+static inline IntLanes lanes_to_int(Lanes a) { return (uint32_t)(int32_t)a; }
+static inline Lanes int_lanes_to_float(IntLanes a) { return (float)(int32_t)a; }
+static inline void int_lanes_store(int32_t* target, IntLanes value) { *target = (int32_t)value; }
+static inline IntLanes int_lanes_add(IntLanes a, IntLanes b) { return a + b; }
+static inline IntLanes int_lanes_mul(IntLanes a, IntLanes b) { return a * b; }
+static inline IntLanes int_lanes_xor(IntLanes a, IntLanes b) { return a ^ b; }
+static inline IntLanes int_lanes_shift_right(IntLanes a, int bits) { return a >> bits; }
+static inline LaneMask int_lanes_test(IntLanes a, int32_t bits) { return (a & (uint32_t)bits) == (uint32_t)bits; }
+
+#endif
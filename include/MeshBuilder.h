@@ -0,0 +1,117 @@
+#pragma once
+#include "gameData.h"
+#include <vector>
+
+// The chunk's columns with a one column border from its neighbours, diagonal ones included
+const int PADDED_CHUNK_SIZE = CHUNK_SIZE + 2;
+// Columns have a block of air below and above them, so the blocks next to every block of the chunk are in the copy
+const int PADDED_COLUMN_HEIGHT = CHUNK_SIZE_VERTICAL + 2;
+
+// Index of a block in a padded copy, x and z go from -1 to CHUNK_SIZE and y from -1 to CHUNK_SIZE_VERTICAL
+inline int get_padded_block_index(int x, int y, int z)
+{
+	return (y + 1) + ((x + 1) + (z + 1) * PADDED_CHUNK_SIZE) * PADDED_COLUMN_HEIGHT;
+}
+
+// Copy of every block a chunk's mesh depends on: the chunk itself and the border column of each of its eight
+// neighbours. The meshers read it without any bounds checks, and meshing a snapshot doesn't touch the world,
+// so it can happen on any thread.
+struct ChunkSnapshot
+{
+	// Air where the neighbour isn't loaded
+	BlockData blocks[PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE * PADDED_COLUMN_HEIGHT];
+	// Sections of the chunk, uniform ones are added to the column masks without reading their blocks
+	BlockData uniformBlocks[CHUNK_SECTION_COUNT];
+	bool isUniform[CHUNK_SECTION_COUNT];
+
+	void copy_from(const Chunk& chunk);
+	BlockData get_block(int x, int y, int z) const { return blocks[get_padded_block_index(x, y, z)]; }
+	// The blocks of the column from y = 0 up
+	const BlockData* get_column(int x, int z) const { return &blocks[get_padded_block_index(x, 0, z)]; }
+};
+
+// CPU side vertices of a chunk, uploaded with Chunk::upload_mesh
+struct ChunkMeshData
+{
+	std::vector<PackedVertexData> vertices;
+	std::vector<PackedVertexData> waterVertices;
+	std::vector<PackedVertexData> transparentVertices;
+
+	// Mesh parts and sections that were built, and where the vertices of every part of every section end.
+	// The parts of the sections that weren't built are left empty
+	uint8_t parts = ALL_MESH_PARTS;
+	uint16_t sections = ALL_MESH_SECTIONS;
+	uint32_t vertexEnds[CHUNK_SECTION_COUNT][MESH_PART_COUNT];
+	uint32_t waterEnds[CHUNK_SECTION_COUNT][MESH_PART_COUNT];
+	uint32_t transparentEnds[CHUNK_SECTION_COUNT][MESH_PART_COUNT];
+};
+
+// Vertices of one section, the builder sorts them by section and joins them once every part is built
+struct SectionVertices
+{
+	std::vector<PackedVertexData> vertices;
+	std::vector<PackedVertexData> waterVertices;
+	std::vector<PackedVertexData> transparentVertices;
+};
+
+// Columns of a chunk from min up to but not including max
+struct ColumnRegion
+{
+	int minX, minZ;
+	int maxX, maxZ;
+};
+
+// A chunk being meshed on a worker, recycled once its result has been collected
+struct MeshJob
+{
+	int x, z;
+	unsigned long long id;
+	MeshingMode mode;
+	uint8_t parts;
+	uint16_t sections;
+	double buildTime;
+	ChunkSnapshot snapshot;
+	ChunkMeshData meshData;
+};
+
+// Column occupancy masks, bit y of a column is set if the block at that height matches.
+// The chunk's columns are padded with a one column border from its neighbours so faces
+// on the chunk edges can be culled with the same bit operations.
+const int COLUMN_WORDS = CHUNK_SIZE_VERTICAL / 64;
+
+struct ColumnMask
+{
+	uint64_t words[COLUMN_WORDS];
+};
+
+struct ChunkMasks
+{
+	ColumnMask solid[PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE];
+	ColumnMask nonAir[PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE];
+	ColumnMask water[CHUNK_SIZE * CHUNK_SIZE];
+	int maxHeight;	// one above the highest cube in the chunk
+};
+
+// Builds chunk vertices on the CPU only, no OpenGL calls are made.
+// Holds the scratch buffers used while meshing, so use one builder per thread.
+struct MeshBuilder
+{
+	ChunkMasks masks;
+
+	// Largest greedy meshing slice is CHUNK_SIZE x CHUNK_SIZE_VERTICAL (faces along x or z).
+	// Every cell holds the key of a visible face, or zero if there is nothing to emit
+	uint32_t faceMask[CHUNK_SIZE * CHUNK_SIZE_VERTICAL];
+	ColumnMask visibleFaces[CHUNK_SIZE * CHUNK_SIZE];
+
+	// Sections being built, and their heights as a column mask
+	uint16_t sections = ALL_MESH_SECTIONS;
+	ColumnMask sectionMask;
+	SectionVertices sectionVertices[CHUNK_SECTION_COUNT];
+
+	void build(const ChunkSnapshot& snapshot, MeshingMode mode, uint8_t parts, uint16_t sections, ChunkMeshData& meshData);
+
+	// The binary and greedy meshers need the masks of the region and the columns around it
+	void build_per_face_mesh(const ChunkSnapshot& snapshot, const ColumnRegion& region);
+	void build_binary_mesh(const ChunkSnapshot& snapshot, const ColumnRegion& region);
+	void build_greedy_mesh(const ChunkSnapshot& snapshot, const ColumnRegion& region);
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+// Counter based random numbers: a value only depends on the seed and the block it's asked for,
+// so chunks can be generated on any thread in any order and always come out the same
+
+// splitmix64 finalizer
+inline uint64_t mix_bits(uint64_t value)
+{
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ull;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebull;
+	value ^= value >> 31;
+	return value;
+}
+
+// Random number for the block (x, y, z) of the chunk (chunkX, chunkZ).
+// Use a different stream for every independent decision made about the same block
+inline uint32_t block_random(uint64_t seed, int chunkX, int chunkZ, int x, int y, int z, uint32_t stream = 0)
+{
+	uint64_t column = ((uint64_t)(uint32_t)(chunkX * 16 + x) << 32) | (uint32_t)(chunkZ * 16 + z);
+	uint64_t block = ((uint64_t)(uint32_t)y << 32) | stream;
+	return (uint32_t)(mix_bits(mix_bits(column ^ seed) ^ block) >> 32);
+}
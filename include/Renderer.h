@@ -16,6 +16,10 @@ enum FACE
 	FACE_BOTTOM = 0b101,
 };
 
+// uv value for faces that span several blocks, the shaders derive the texture coordinates
+// from the vertex position instead so the texture repeats once per block
+const char TILED_UV = 0b100;
+
 struct PackedVertexData
 {
 	char x, y, z;
@@ -40,9 +44,13 @@ uint8_t get_AO(PackedVertexData &vertexData);
 struct Mesh
 {
 	std::vector<PackedVertexData> vertices;
-	GLuint VAO, VBO, EBO;
+	GLuint VAO = 0, VBO = 0, EBO = 0;
+	size_t capacity = 0;	// Vertices the buffer has room for
 
-	void setup();
+	// Only the vertices from firstChanged on are uploaded again when they still fit in the buffer
+	void setup(size_t firstChanged = 0);
+	// Frees the GL objects and the vertex memory, needs the GL context like setup
+	void clear();
 };
 
 struct Shader
@@ -115,6 +123,7 @@ const float PITCH = 0.0f;
 const float SPEED = 16;
 const float SENSITIVITY = 0.1f;
 const float ZOOM = 45.0f;
+const float ASPECT_RATIO = 800.0f / 600.0f;	// Of the projection, whatever the window size
 
 enum CAMERA_MOVEMENT {
 	FORWARD,
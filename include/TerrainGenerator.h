@@ -0,0 +1,139 @@
+#pragma once
+#include "gameData.h"
+#include <mutex>
+#include <vector>
+
+// sin with a polynomial after range reduction to [-pi/2, pi/2]. The max absolute error is below 4e-7 for the angles
+// of the sine terrain up to 65536 blocks out (tests/fast_sin.cpp), the reduction loses precision further out.
+// The AVX2, SSE2 and scalar paths run the same float operations (no fma), so they give the same heights
+float fast_sin(float angle);
+
+// Produces the terrain height of every column of a chunk, generate_chunk_data turns the heights into blocks.
+// Called from the worker threads at the same time, so generators must not change any state while generating
+struct TerrainGenerator
+{
+	virtual ~TerrainGenerator() = default;
+
+	// Heights are indexed x + z * CHUNK_SIZE
+	virtual void generate_heightmap(int chunkX, int chunkZ, int heights[CHUNK_SIZE * CHUNK_SIZE]) const = 0;
+};
+
+// The original sum of sines. Every sine term only depends on x or on z, so they are evaluated
+// once per row and column in SIMD lanes and then combined over the whole grid
+struct SineTerrainGenerator : TerrainGenerator
+{
+	void generate_heightmap(int chunkX, int chunkZ, int heights[CHUNK_SIZE * CHUNK_SIZE]) const override;
+};
+
+// Fractal gradient (Perlin) noise, evaluated a row of 16 columns at a time in SIMD lanes.
+// The lattice gradients come from a hash of the lattice coordinates, so there's no permutation table to gather from
+struct NoiseTerrainGenerator : TerrainGenerator
+{
+	uint32_t seed = 0;
+	int octaves = 5;
+	float frequency = 1.0f / 256.0f;	// Of the first octave, in blocks
+	float baseHeight = 68.0f;
+	float amplitude = 72.0f;
+
+	void generate_heightmap(int chunkX, int chunkZ, int heights[CHUNK_SIZE * CHUNK_SIZE]) const override;
+};
+
+TerrainGenerator* create_terrain_generator(TerrainType type, uint64_t seed);
+
+// Caves are carved where a 3D density is above zero. Full resolution noise is too slow, so the density
+// is only sampled on the corners of 4x8x4 block cells and trilinearly interpolated in between
+static const int CAVE_CELL_WIDTH = 4;
+static const int CAVE_CELL_HEIGHT = 8;
+static const int CAVE_CELLS = CHUNK_SIZE / CAVE_CELL_WIDTH;
+static const int CAVE_CELLS_VERTICAL = CHUNK_SIZE_VERTICAL / CAVE_CELL_HEIGHT;
+static const int CAVE_LATTICE_HEIGHT = CAVE_CELLS_VERTICAL + 8;	// Room for the lanes written past the top corner
+
+enum CaveCellState : uint8_t
+{
+	CAVE_CELL_SOLID,	// Every corner is below zero, so nothing in the cell is carved
+	CAVE_CELL_OPEN,		// Every corner is above zero, the whole cell is carved
+	CAVE_CELL_MIXED,	// Needs interpolating block by block
+};
+
+struct CaveDensity
+{
+	float lattice[(CAVE_CELLS + 1) * (CAVE_CELLS + 1)][CAVE_LATTICE_HEIGHT];	// Corner columns indexed x + z * (CAVE_CELLS + 1)
+	CaveCellState cells[CAVE_CELLS * CAVE_CELLS][CAVE_CELLS_VERTICAL];		// Cell columns indexed x + z * CAVE_CELLS
+
+	bool section_has_caves(int section) const;
+	// Turns the cave blocks of the column between bottom and top into air
+	void carve_column(int x, int z, int bottom, int top, BlockData* column) const;
+};
+
+struct CaveGenerator
+{
+	uint32_t seed = 0;
+	float frequency = 1.0f / 48.0f;
+	float verticalFrequency = 1.0f / 32.0f;
+	float threshold = 0.4f;	// Higher makes fewer and narrower caves
+
+	// Only the cells below top are sampled, the ones above it are left solid
+	void generate_density(int chunkX, int chunkZ, int top, CaveDensity& density) const;
+};
+
+CaveGenerator* create_cave_generator(uint64_t seed);
+
+enum Biome : uint8_t
+{
+	PLAINS_BIOME,	// Grass over dirt, with sandy shores
+	DESERT_BIOME,	// Sand all the way down to the stone
+	SNOW_BIOME,		// Snow over dirt, also on the peaks of every other biome
+	BIOME_COUNT,
+};
+
+// Climate changes slowly, so it's only sampled every 4 columns and interpolated for the columns in between
+static const int BIOME_SAMPLE_SPACING = 4;
+static const int BIOME_CHUNK_SAMPLES = CHUNK_SIZE / BIOME_SAMPLE_SPACING + 1;
+static const int BIOME_REGION_CHUNKS = 8;
+static const int BIOME_REGION_SAMPLES = BIOME_REGION_CHUNKS * CHUNK_SIZE / BIOME_SAMPLE_SPACING + 1;
+
+struct Climate
+{
+	float temperature = 0;
+	float humidity = 0;
+};
+
+// The climate samples on and around one chunk, indexed x + z * BIOME_CHUNK_SAMPLES
+struct ChunkClimate
+{
+	Climate samples[BIOME_CHUNK_SAMPLES * BIOME_CHUNK_SAMPLES];
+
+	// Higher columns are colder, which is what puts snow on mountains in warm biomes
+	Biome get_biome(int x, int z, int height) const;
+};
+
+// Climate samples are generated for regions of 8x8 chunks and cached, so neighbouring chunks share them
+// instead of sampling the edges twice. The workers read it at the same time, every access locks the mutex
+struct BiomeMap
+{
+	struct Region
+	{
+		int x = 0;
+		int z = 0;
+		unsigned long long lastUse = 0;
+		Climate samples[BIOME_REGION_SAMPLES * BIOME_REGION_SAMPLES];
+	};
+
+	uint32_t seed = 0;
+	float frequency = 1.0f / 512.0f;
+	size_t maxRegions = 64;	// Least recently used regions are dropped past this
+
+	std::mutex mutex;
+	std::vector<Region*> regions;
+	unsigned long long lastUse = 0;
+
+	BiomeMap() = default;
+	BiomeMap(const BiomeMap&) = delete;
+	BiomeMap& operator=(const BiomeMap&) = delete;
+	~BiomeMap();
+
+	void get_chunk_climate(int chunkX, int chunkZ, ChunkClimate& climate);
+	void generate_region(Region& region) const;
+};
+
+BiomeMap* create_biome_map(uint64_t seed);
@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed set of worker threads that run submitted jobs in the order they were submitted
+struct ThreadPool
+{
+	std::vector<std::thread> workers;
+	std::deque<std::function<void(unsigned)>> jobs;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	bool stopping = false;
+
+	// One worker per core, leaving a core for the render thread
+	static unsigned default_worker_count();
+
+	void start(unsigned workerCount);
+
+	// Finishes every queued job, then joins the workers
+	void stop();
+
+	// The job gets the index of the worker running it, to pick per worker scratch data
+	void submit(std::function<void(unsigned workerIndex)> job);
+
+	bool is_running() const;
+	unsigned worker_count() const;
+	size_t queued_jobs();
+};
@@ -1,14 +1,27 @@
 #pragma once
 #include "Renderer.h"
+#include "ThreadPool.h"
+#include <atomic>
 #include <map>
 #include <tuple>
-#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
 
 const int CHUNK_SIZE = 16;
 const int CHUNK_SIZE_VERTICAL = 256;
+const int CHUNK_SECTION_HEIGHT = 16;
+const int CHUNK_SECTION_COUNT = CHUNK_SIZE_VERTICAL / CHUNK_SECTION_HEIGHT;
+const int CHUNK_SECTION_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SECTION_HEIGHT;
+
+// Blocks of a section are stored column by column so every column is a contiguous run of CHUNK_SECTION_HEIGHT bytes
+inline int get_section_block_index(int x, int y, int z)
+{
+	return (y & (CHUNK_SECTION_HEIGHT - 1)) + (x + z * CHUNK_SIZE) * CHUNK_SECTION_HEIGHT;
+}
 
 
-enum BlockType
+enum BlockType : uint8_t
 {
 	AIR_BLOCK,
 	GRASS_BLOCK,
@@ -19,6 +32,8 @@ enum BlockType
 	SNOW_BLOCK,
 	RED_FLOWER,
 	YELLOW_FLOWER,
+	LOG_BLOCK,
+	LEAVES_BLOCK,
 	BLOCK_TYPE_COUNT,
 };
 
@@ -37,13 +52,122 @@ enum MeshType
 	MESH_TYPE_COUNT,
 };
 
+enum MeshingMode
+{
+	PER_FACE_MESHING,
+	BINARY_MESHING,
+	GREEDY_MESHING,
+	MESHING_MODE_COUNT,
+};
+
+enum TerrainType
+{
+	SINE_TERRAIN,
+	NOISE_TERRAIN,
+	TERRAIN_TYPE_COUNT,
+};
+
 typedef BlockType BlockData;
 
+// 16 block high slice of a chunk. A section made of a single block type only stores that block
+struct ChunkSection
+{
+	BlockData uniformBlock = AIR_BLOCK;
+	BlockData* blocks = nullptr;	// CHUNK_SECTION_VOLUME blocks, nullptr while the section is uniform
+
+	ChunkSection() = default;
+	ChunkSection(const ChunkSection&) = delete;
+	ChunkSection& operator=(const ChunkSection&) = delete;
+	~ChunkSection() { delete[] blocks; }
+
+	bool is_uniform() const { return blocks == nullptr; }
+	BlockData get(int x, int y, int z) const { return blocks ? blocks[get_section_block_index(x, y, z)] : uniformBlock; }
+	void set(BlockData value, int x, int y, int z);
+	void fill(BlockData value);
+	// Makes the section uniform again if all of its blocks are the same
+	void compact();
+	// Copies the CHUNK_SECTION_HEIGHT blocks of the column (x, z) to target
+	void copy_column(int x, int z, BlockData* target) const;
+	// Replaces the CHUNK_SECTION_HEIGHT blocks of the column (x, z) with source
+	void set_column(int x, int z, const BlockData* source);
+};
+
+struct ChunkSnapshot;
+struct ChunkMeshData;
+struct MeshBuilder;
+struct MeshJob;
+struct TerrainGenerator;
+struct CaveGenerator;
+struct BiomeMap;
+
+// Where a chunk is in its life, from being taken out of the pool to going back to it.
+// Positions waiting in the load queue have no chunk yet
+enum ChunkState : uint8_t
+{
+	GENERATING_STATE,	// A worker is generating the base terrain
+	GENERATED_STATE,	// Base terrain only, waits for its neighbours in range to be generated before it's populated
+	POPULATED_STATE,	// Trees (which can reach into the neighbours) are placed, waits to be meshed the first time
+	MESHING_STATE,		// A worker builds the mesh, the previous one is still drawn
+	READY_STATE,		// The mesh is uploaded, meshed again when it gets dirty
+	EVICTING_STATE,		// Out of range, goes back to the pool at the end of the frame or once its worker is done
+	CHUNK_STATE_COUNT,
+};
+
+// A chunk mesh is built in parts that can be rebuilt on their own and are joined when uploaded: the interior
+// and a one column strip along every side, which is all a neighbour can change. The left and right strips
+// hold the corner columns, so the back and front neighbours change those strips too
+enum MeshPart : uint8_t
+{
+	INTERIOR_PART,
+	LEFT_PART,		// x = 0
+	RIGHT_PART,		// x = CHUNK_SIZE - 1
+	BACK_PART,		// z = 0, without the corners
+	FRONT_PART,		// z = CHUNK_SIZE - 1, without the corners
+	MESH_PART_COUNT,
+};
+const uint8_t ALL_MESH_PARTS = (1 << MESH_PART_COUNT) - 1;
+
+// Every part is split further by section, so an edit only builds the sections around it again
+static_assert(CHUNK_SECTION_COUNT <= 16, "Mesh sections are tracked in 16 bits");
+const uint16_t ALL_MESH_SECTIONS = (1 << CHUNK_SECTION_COUNT) - 1;
+
+// Bits of the parts that hold any column of the box, the bounds are included and clamped to the chunk
+uint8_t get_mesh_parts(int minX, int minZ, int maxX, int maxZ);
+// Bits of the sections between the heights, included and clamped like get_mesh_parts
+uint16_t get_mesh_sections(int minY, int maxY);
+
+// A tree found when generating the terrain, placed when the chunk is populated. Local coordinates
+struct TreeFeature
+{
+	uint8_t x;
+	uint8_t y;	// Lowest block of the trunk
+	uint8_t z;
+	uint8_t trunkHeight;
+};
+
+// A block change in world coordinates, collected and applied in batches by World::apply_block_edits
+struct BlockEdit
+{
+	int x;
+	int y;
+	int z;
+	BlockData block;
+	bool replaceSolid;	// Otherwise only air and flowers are replaced, and leaves by logs
+};
+
 struct Chunk
 {
 	glm::vec3 position = glm::vec3(0,0,0);
-	BlockData data[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE_VERTICAL];
-	bool dirty = true;
+	ChunkSection sections[CHUNK_SECTION_COUNT];
+	// The box of mesh parts and sections that have to be built again, both are 0 when the mesh is up to date
+	uint8_t dirtyParts = ALL_MESH_PARTS;
+	uint16_t dirtySections = ALL_MESH_SECTIONS;
+	unsigned long long meshJobId = 0;	// Mesh being built on a worker, 0 if there is none
+	// Changed by the workers too. A transition only happens from the expected state, so a chunk evicted
+	// while a worker generates it stays evicted
+	std::atomic<ChunkState> state = GENERATING_STATE;
+	double generatedTime = 0;	// When it was added to the world, the wait for the neighbours starts then
+	std::vector<TreeFeature> trees;	// Kept after populating, so neighbours generated again later get their leaves back
 
 	Chunk *left;
 	Chunk *right;
@@ -53,34 +177,244 @@ struct Chunk
 	Mesh mesh;
 	Mesh waterMesh;
 	Mesh transparentMesh;
+	// Where the vertices of every part of every section end in the meshes, the sections come one after another
+	uint32_t vertexEnds[CHUNK_SECTION_COUNT][MESH_PART_COUNT] = {};
+	uint32_t waterEnds[CHUNK_SECTION_COUNT][MESH_PART_COUNT] = {};
+	uint32_t transparentEnds[CHUNK_SECTION_COUNT][MESH_PART_COUNT] = {};
 
 	BlockData get_block_at(int x, unsigned y, int z);
+	BlockData get_local_block(int x, int y, int z) const { return sections[y / CHUNK_SECTION_HEIGHT].get(x, y, z); }
+	// Only writes the block, World::apply_block_edits marks the meshes around it dirty
 	void set_block(BlockData value, unsigned x, unsigned y, unsigned z);
+	void compact();
+	size_t get_memory_usage() const;
 
-	void generate_mesh();
+	ChunkState get_state() const { return state.load(); }
+	bool transition(ChunkState from, ChunkState to) { return state.compare_exchange_strong(from, to); }
+	bool is_populated() const
+	{
+		ChunkState current = get_state();
+		return current == POPULATED_STATE || current == MESHING_STATE || current == READY_STATE;
+	}
+
+	void upload_mesh(ChunkMeshData& meshData);
+	void reset();
+};
+
+// Chunks that went out of range, kept with their vertex capacity and GL buffers so loading
+// new chunks doesn't allocate. Only used from the main thread
+struct ChunkPool
+{
+	std::vector<Chunk*> freeChunks;
+	size_t allocatedChunks = 0;
+
+	Chunk* acquire();
+	void release(Chunk* chunk);
+
+	// Deletes the pooled chunks along with their GL objects
+	void clear();
+};
+
+// Window of loaded chunks that wraps around: a chunk lives in the slot of its coordinates modulo the
+// grid size, so the window follows the player without moving anything and lookups are a single index.
+// The size is a power of two of at least 2 * (RENDER_DISTANCE + MAX_PREFETCH_DISTANCE), so no two chunks in range share a slot.
+struct ChunkGrid
+{
+	struct Slot
+	{
+		int x = 0;
+		int z = 0;
+		Chunk* chunk = nullptr;
+	};
+
+	std::vector<Slot> slots;
+	int size = 0;
+	int mask = 0;
+	size_t count = 0;
+
+	// Drops every slot, the chunks have to be deleted or moved out beforehand
+	void reset(int minSize);
+
+	Slot& slot_at(int x, int z) { return slots[(x & mask) + (z & mask) * size]; }
+	Chunk* get(int x, int z)
+	{
+		Slot& slot = slot_at(x, z);
+		return (slot.chunk != nullptr && slot.x == x && slot.z == z) ? slot.chunk : nullptr;
+	}
+	void insert(int x, int z, Chunk* chunk);
+	void remove(int x, int z);
+};
+
+// Chunks waiting to be generated, the lowest priority value comes out first. A position is only queued once.
+// The heap isn't searched when positions are dropped or change priority, its outdated entries are skipped by pop
+struct ChunkLoadQueue
+{
+	struct Entry
+	{
+		int x = 0;
+		int z = 0;
+		int priority = 0;
+	};
+
+	std::vector<Entry> heap;
+	std::unordered_map<uint64_t, Entry> queued;
+
+	static uint64_t get_key(int x, int z) { return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z; }
+
+	bool contains(int x, int z) const { return queued.count(get_key(x, z)) != 0; }
+	size_t size() const { return queued.size(); }
+	// Does nothing if the position is queued already
+	void push(int x, int z, int priority);
+	bool pop(int& x, int& z);
+	void clear();
+
+	// Gives every queued position a new priority, the ones get_priority returns a negative priority for are dropped
+	template<typename GetPriority>
+	void reprioritize(GetPriority get_priority)
+	{
+		for (auto it = queued.begin(); it != queued.end();)
+		{
+			it->second.priority = get_priority(it->second.x, it->second.z);
+			if (it->second.priority < 0) it = queued.erase(it);
+			else ++it;
+		}
+		rebuild_heap();
+	}
+	void rebuild_heap();
+};
+
+enum FrameWork : uint8_t
+{
+	GENERATION_WORK,	// Chunk generation on the workers
+	MESHING_WORK,		// Snapshots on the main thread and mesh building on the workers
+	UPLOAD_WORK,		// Mesh uploads on the main thread
+	FRAME_WORK_COUNT,
+};
+
+// Milliseconds of chunk work allowed per frame. Chunks cost very different amounts of time (an ocean is much
+// cheaper than mountains), so counting them can't hold the frame time. Main thread work is charged the time it took,
+// jobs for the workers their measured average. What doesn't fit waits for the next frame
+struct FrameBudget
+{
+	float budgets[FRAME_WORK_COUNT] = { 8.0f, 8.0f, 2.0f };
+	double spent[FRAME_WORK_COUNT] = {};		// This frame
+	double usage[FRAME_WORK_COUNT] = {};		// Smoothed spent time, shown in the settings
+	double jobCost[FRAME_WORK_COUNT] = { 1.0, 1.0, 0.0 };	// Average of the worker jobs, a guess until they report back
+
+	void begin_frame();
+	void end_frame();
+	bool has_time(FrameWork work) const { return spent[work] < budgets[work]; }
+	void charge(FrameWork work, double milliseconds) { spent[work] += milliseconds; }
+	void add_job_time(FrameWork work, double milliseconds);
 };
 
 struct World
 {
-	std::map<std::tuple<int, int>, Chunk*> chunks;
+	ChunkGrid chunks;
+	ChunkPool chunkPool;
 	std::vector<std::tuple<int, int>> sortedChunkIndicies;
-	std::deque<std::tuple<int, int>> chunkQueue;
+	ChunkLoadQueue chunkQueue;
 	std::vector<std::tuple<int, int>> chunksToDelete;
 
+	uint64_t seed = 20;
 	int RENDER_DISTANCE = 16;
-	int maxChunksPerFrame = 8;
+	FrameBudget frameBudget;
+	MeshingMode meshingMode = GREEDY_MESHING;
+	// Population waits for the neighbours to be generated and the first mesh for them to be populated, their trees
+	// can reach into the chunk. Neighbours far back in the load queue would hold the chunk up, so this many seconds
+	// after it was generated it's populated and meshed with the neighbours it has
+	float meshWaitTime = 0.1f;
+	TerrainType terrainType = NOISE_TERRAIN;
+	TerrainGenerator* terrainGenerator = nullptr;	// Shared by the workers, created with them
+	bool enableCaves = true;
+	CaveGenerator* caveGenerator = nullptr;		// Same as terrainGenerator, stays null without caves
+	BiomeMap* biomeMap = nullptr;				// Caches the climate around the loaded chunks for the workers
+
+	// Chunk generation and meshing run on the workers, only the GPU upload happens on the main thread
+	ThreadPool workerPool;
+	int workerCount = ThreadPool::default_worker_count();
+	std::vector<MeshBuilder*> meshBuilders;	// One per worker
+
+	// Chunks being generated by the workers
+	std::map<std::tuple<int, int>, Chunk*> chunksInProgress;
+	unsigned long long lastMeshJobId = 0;
+	std::vector<MeshJob*> freeMeshJobs;
+
+	// Filled by the workers, collected once per frame by apply_updates
+	std::mutex finishedJobsMutex;
+	std::vector<std::tuple<int, int, Chunk*>> generatedChunks;
+	double generationTime = 0;	// Of the chunks in generatedChunks, in seconds
+	std::vector<MeshJob*> finishedMeshJobs;
+	// Finished meshes that didn't fit in the upload budget yet
+	std::vector<MeshJob*> meshUploads;
+
+	// Generated chunks that might have all their neighbours now, checked by populate_chunks every frame until they do
+	std::vector<std::tuple<int, int>> populationCandidates;
+	// Edits are applied once per frame, so a chunk changed by many features is only meshed again once
+	std::vector<BlockEdit> pendingEdits;
+	// Chunks that turned dirty, or became ready to be meshed while dirty. The ones over the meshing budget
+	// stay for the next frame, so an idle frame doesn't look at any chunk
+	std::vector<std::tuple<int, int>> meshCandidates;
+	// Mesh candidates of this frame in load priority order, so the ones in view are done first
+	std::vector<ChunkLoadQueue::Entry> meshOrder;
+
+	// Time spent building chunk meshes, used to compare meshing modes
+	double totalMeshTime = 0;
+	unsigned meshedChunks = 0;
+	// Meshes built again for chunks that had one already, compared to the chunks generated
+	unsigned long long generatedChunkCount = 0;
+	unsigned long long remeshCount = 0;
 
 	int lastX = 0;
 	int lastZ = 0;
 
+	// Horizontal view direction the load priorities were worked out for, and the cosine of half the view angle
+	glm::vec2 viewDirection = glm::vec2(0, -1);
+	float viewCosine = 0.5f;
+
+	// Moving fast, the chunks on the way are loaded around where the player will be prefetchTime seconds later.
+	// The loaded square is shifted towards it by up to MAX_PREFETCH_DISTANCE chunks
+	static const int MAX_PREFETCH_DISTANCE = 4;
+	bool enablePrefetch = true;
+	float prefetchTime = 2.0f;
+	glm::vec2 cameraVelocity = glm::vec2(0);	// Horizontal, in blocks per second
+	glm::vec2 lastCameraPos = glm::vec2(0);
+	double lastStateUpdate = 0;
+	int prefetchX = 0;	// Offset of the prefetched square from the one around the player, in chunks
+	int prefetchZ = 0;
+
 	bool firstLoad = true;
 
 	Chunk* get_chunk(int x, int z);
+	void add_chunk(int x, int z, Chunk* chunk);
+	void delete_chunk(int x, int z);
+	void mark_neighbours_dirty(int x, int z);
+	void mark_dirty(Chunk* chunk, int x, int z, uint8_t parts = ALL_MESH_PARTS, uint16_t sections = ALL_MESH_SECTIONS);
+	bool is_ready_to_mesh(Chunk* chunk, int x, int z, double now);
+	void resize_grid();
 	void render(const Shader &terrainShader, const Shader &waterShader, const Camera &camera);
-	void generate_chunk_data(int chunkX, int chunkZ);
+	bool is_in_view_distance(int x, int z);
+	bool is_in_range(int x, int z);
+	int get_load_priority(int x, int z);
+	void generate_chunk_data(Chunk* chunk, int chunkX, int chunkZ);
+	void start_workers();
+	void stop_workers();
+	void collect_finished_jobs();
+	void schedule_mesh(Chunk* chunk, int x, int z);
+	void queue_block_edit(int x, int y, int z, BlockData block, bool replaceSolid = true);
+	void apply_block_edits();
+	bool is_waiting_for_neighbour(int x, int z);
+	void populate_chunks();
+	void populate_chunk(Chunk* chunk, int chunkX, int chunkZ);
 	void apply_updates();
-	void update_state(glm::vec3 currentPos);
+	bool update_view(const Camera& camera);
+	bool update_prefetch(const Camera& camera);
+	void update_state(const Camera& camera);
+	void count_chunk_states(size_t counts[CHUNK_STATE_COUNT]);
 	void delete_all();
+	void regenerate();
 };
 
 glm::vec3 get_block_textureID(BlockType block);
+BlockCategory get_block_category(BlockType block);
+MeshType get_block_mesh(BlockType block);
@@ -1,19 +1,14 @@
 #include "gameData.h"
+#include "MeshBuilder.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "Logger.h"
+#include <algorithm>
 
-#include "Cube.h"
+#pragma region BLOCK_PROPERTIES
 
-#pragma region STATIC_FUNCTIONS
-
-static int calculate_AO(bool side1, bool side2, bool corner) {
-	if (side1 && side2) return 0;
-	return 3 - (side1 + side2 + corner);
-}
-
-static glm::vec3 get_block_textureID(BlockType block)
+glm::vec3 get_block_textureID(BlockType block)
 {
 	glm::vec3 blockTextures[BLOCK_TYPE_COUNT - 1] = {
 		glm::vec3(3,0,3), // GRASS_BLOCK
@@ -24,6 +19,8 @@ static glm::vec3 get_block_textureID(BlockType block)
 		glm::vec3(66,66,66),  // SNOW_BLOCK
 		glm::vec3(12,12,12),  // RED_FLOWER
 		glm::vec3(13,13,13),  // YELLOW_FLOWER
+		glm::vec3(20,21,20),  // LOG_BLOCK
+		glm::vec3(53,53,53),  // LEAVES_BLOCK
 	};
 
 	if (block > 0 && block < BLOCK_TYPE_COUNT)
@@ -33,14 +30,14 @@ static glm::vec3 get_block_textureID(BlockType block)
 	return glm::vec3(14, 14, 14);	// return empty texture(pink color) if block id is invalid
 }
 
-static BlockCategory get_block_category(BlockType block)
+BlockCategory get_block_category(BlockType block)
 {
 	if (block == WATER_BLOCK) return WATER;
 	if (block == RED_FLOWER || block == YELLOW_FLOWER) return TRANSPARENT;
 	return SOLID;
 }
 
-static MeshType get_block_mesh(BlockType block)
+MeshType get_block_mesh(BlockType block)
 {
 	if (block == RED_FLOWER || block == YELLOW_FLOWER) return CROSS_MESH;
 	return CUBE_MESH;
@@ -48,6 +45,62 @@ static MeshType get_block_mesh(BlockType block)
 
 #pragma endregion
 
+#pragma region CHUNK_SECTION
+
+void ChunkSection::set(BlockData value, int x, int y, int z)
+{
+	if (blocks == nullptr)
+	{
+		if (value == uniformBlock) return;
+		blocks = new BlockData[CHUNK_SECTION_VOLUME];
+		std::fill(blocks, blocks + CHUNK_SECTION_VOLUME, uniformBlock);
+	}
+	blocks[get_section_block_index(x, y, z)] = value;
+}
+
+void ChunkSection::fill(BlockData value)
+{
+	delete[] blocks;
+	blocks = nullptr;
+	uniformBlock = value;
+}
+
+void ChunkSection::compact()
+{
+	if (blocks == nullptr) return;
+
+	BlockData first = blocks[0];
+	for (int i = 1; i < CHUNK_SECTION_VOLUME; ++i)
+	{
+		if (blocks[i] != first) return;
+	}
+	fill(first);
+}
+
+void ChunkSection::copy_column(int x, int z, BlockData* target) const
+{
+	if (blocks == nullptr)
+	{
+		std::fill(target, target + CHUNK_SECTION_HEIGHT, uniformBlock);
+		return;
+	}
+	const BlockData* column = &blocks[get_section_block_index(x, 0, z)];
+	std::copy(column, column + CHUNK_SECTION_HEIGHT, target);
+}
+
+void ChunkSection::set_column(int x, int z, const BlockData* source)
+{
+	if (blocks == nullptr)
+	{
+		if (std::all_of(source, source + CHUNK_SECTION_HEIGHT, [this](BlockData block) { return block == uniformBlock; })) return;
+		blocks = new BlockData[CHUNK_SECTION_VOLUME];
+		std::fill(blocks, blocks + CHUNK_SECTION_VOLUME, uniformBlock);
+	}
+	std::copy(source, source + CHUNK_SECTION_HEIGHT, &blocks[get_section_block_index(x, 0, z)]);
+}
+
+#pragma endregion
+
 #pragma region CHUNK_STUFF
 
 BlockData Chunk::get_block_at(int x, unsigned y, int z)
@@ -63,24 +116,56 @@ BlockData Chunk::get_block_at(int x, unsigned y, int z)
 
 	// Handle neighbor chunks
 	if (x == -1 && left != nullptr)
-		return left->data[(CHUNK_SIZE - 1) | (z * CHUNK_SIZE) | (y * CHUNK_SIZE * CHUNK_SIZE)];
+		return left->get_local_block(CHUNK_SIZE - 1, y, z);
 
 	if (x == CHUNK_SIZE && right != nullptr)
-		return right->data[0 | (z * CHUNK_SIZE) | (y * CHUNK_SIZE * CHUNK_SIZE)];
+		return right->get_local_block(0, y, z);
 
 	if (z == -1 && back != nullptr)
-		return back->data[x | ((CHUNK_SIZE - 1) * CHUNK_SIZE) | (y * CHUNK_SIZE * CHUNK_SIZE)];
+		return back->get_local_block(x, y, CHUNK_SIZE - 1);
 
 	if (z == CHUNK_SIZE && front != nullptr)
-		return front->data[x | (0 * CHUNK_SIZE) | (y * CHUNK_SIZE * CHUNK_SIZE)];
+		return front->get_local_block(x, y, 0);
 
 	// Return block from the current chunk if within bounds
 	if (x >= 0 && x < CHUNK_SIZE && z >= 0 && z < CHUNK_SIZE)
-		return data[x | (z * CHUNK_SIZE) | (y * CHUNK_SIZE * CHUNK_SIZE)];
+		return get_local_block(x, y, z);
 
 	return AIR_BLOCK;
 }
 
+uint8_t get_mesh_parts(int minX, int minZ, int maxX, int maxZ)
+{
+	minX = std::max(minX, 0);
+	minZ = std::max(minZ, 0);
+	maxX = std::min(maxX, CHUNK_SIZE - 1);
+	maxZ = std::min(maxZ, CHUNK_SIZE - 1);
+	if (minX > maxX || minZ > maxZ) return 0;
+
+	uint8_t parts = 0;
+	if (minX == 0) parts |= 1 << LEFT_PART;
+	if (maxX == CHUNK_SIZE - 1) parts |= 1 << RIGHT_PART;
+
+	// The columns between the left and right strips
+	if (maxX >= 1 && minX <= CHUNK_SIZE - 2)
+	{
+		if (minZ == 0) parts |= 1 << BACK_PART;
+		if (maxZ == CHUNK_SIZE - 1) parts |= 1 << FRONT_PART;
+		if (maxZ >= 1 && minZ <= CHUNK_SIZE - 2) parts |= 1 << INTERIOR_PART;
+	}
+	return parts;
+}
+
+uint16_t get_mesh_sections(int minY, int maxY)
+{
+	minY = std::max(minY, 0);
+	maxY = std::min(maxY, CHUNK_SIZE_VERTICAL - 1);
+	if (minY > maxY) return 0;
+
+	int bottom = minY / CHUNK_SECTION_HEIGHT;
+	int top = maxY / CHUNK_SECTION_HEIGHT;
+	return (uint16_t)(((1 << (top + 1)) - 1) & ~((1 << bottom) - 1));
+}
 
 void Chunk::set_block(BlockData value, unsigned x, unsigned y, unsigned z)
 {
@@ -89,198 +174,129 @@ void Chunk::set_block(BlockData value, unsigned x, unsigned y, unsigned z)
 		Log_warn << "Tried to set block at invalid coordinates. X: " << x << "Y: " << y << "Z: " << z << "\n";
 		return;
 	}
-	data[x | (z * CHUNK_SIZE) | (y * CHUNK_SIZE * CHUNK_SIZE)] = value;
-	dirty = true;
+	sections[y / CHUNK_SECTION_HEIGHT].set(value, x, y, z);
 }
 
-void Chunk::generate_mesh()
+void Chunk::compact()
 {
-	const glm::vec3 offsets[] = {
-		{0, 0, -1},  // back face
-		{0, 0, 1},   // front face
-		{-1, 0, 0},  // left face
-		{1, 0, 0},   // right face
-		{0, -1, 0},  // bottom face
-		{0, 1, 0}    // top face
-	};
+	for (ChunkSection& section : sections) section.compact();
+}
 
-	// Abs value of relative positions of blocks used to calculate ambient oclusion for each vertex
-	const glm::vec3 sideOffsets[3][2] = {
-		{{1,0,0}, {0,1,0}},
-		{{0, 1,0}, {0,0,1}},
-		{{1,0,0}, {0,0,1}}
-	};
+size_t Chunk::get_memory_usage() const
+{
+	size_t size = sizeof(Chunk);
+	for (const ChunkSection& section : sections)
+	{
+		if (!section.is_uniform()) size += CHUNK_SECTION_VOLUME * sizeof(BlockData);
+	}
+	return size;
+}
+
+// Replaces the vertices of the parts of the sections that were built, the others keep theirs.
+// Returns the index of the first vertex that was replaced, the ones before it didn't move
+static size_t splice_mesh_parts(std::vector<PackedVertexData>& vertices, uint32_t (&ends)[CHUNK_SECTION_COUNT][MESH_PART_COUNT],
+	std::vector<PackedVertexData>& built, const uint32_t (&builtEnds)[CHUNK_SECTION_COUNT][MESH_PART_COUNT], uint8_t parts, uint16_t sections)
+{
+	// Swap so the old vectors' memory gets reused by the next build
+	if (parts == ALL_MESH_PARTS && sections == ALL_MESH_SECTIONS)
+	{
+		vertices.swap(built);
+		std::copy(&builtEnds[0][0], &builtEnds[0][0] + CHUNK_SECTION_COUNT * MESH_PART_COUNT, &ends[0][0]);
+		return 0;
+	}
+
+	const int pieceCount = CHUNK_SECTION_COUNT * MESH_PART_COUNT;
+	auto is_built = [&](int piece) { return (sections & (1 << (piece / MESH_PART_COUNT))) && (parts & (1 << (piece % MESH_PART_COUNT))); };
+	int first = 0;
+	while (first < pieceCount && !is_built(first)) ++first;
+	if (first == pieceCount) return vertices.size();
+
+	// Only the pieces from the first built one on are put together again
+	uint32_t firstChanged = first > 0 ? ends[(first - 1) / MESH_PART_COUNT][(first - 1) % MESH_PART_COUNT] : 0;
+	std::vector<PackedVertexData> oldVertices(vertices.begin() + firstChanged, vertices.end());
+	vertices.resize(firstChanged);
+	uint32_t start = firstChanged;
+	uint32_t builtStart = 0;
+	for (int piece = first; piece < pieceCount; ++piece)
+	{
+		uint32_t& end = ends[piece / MESH_PART_COUNT][piece % MESH_PART_COUNT];
+		uint32_t builtEnd = builtEnds[piece / MESH_PART_COUNT][piece % MESH_PART_COUNT];
+		if (is_built(piece)) vertices.insert(vertices.end(), built.begin() + builtStart, built.begin() + builtEnd);
+		else vertices.insert(vertices.end(), oldVertices.begin() + (start - firstChanged), oldVertices.begin() + (end - firstChanged));
+		start = end;
+		builtStart = builtEnd;
+		end = (uint32_t)vertices.size();
+	}
+	return firstChanged;
+}
+
+void Chunk::upload_mesh(ChunkMeshData& meshData)
+{
+	size_t firstVertex = splice_mesh_parts(mesh.vertices, vertexEnds, meshData.vertices, meshData.vertexEnds, meshData.parts, meshData.sections);
+	size_t firstWaterVertex = splice_mesh_parts(waterMesh.vertices, waterEnds, meshData.waterVertices, meshData.waterEnds, meshData.parts, meshData.sections);
+	size_t firstTransparentVertex = splice_mesh_parts(transparentMesh.vertices, transparentEnds, meshData.transparentVertices, meshData.transparentEnds, meshData.parts, meshData.sections);
+
+	mesh.setup(firstVertex);
+	waterMesh.setup(firstWaterVertex);
+	transparentMesh.setup(firstTransparentVertex);
+}
 
+// Readies a pooled chunk to be generated again, the data gets overwritten by the generator
+void Chunk::reset()
+{
+	dirtyParts = ALL_MESH_PARTS;
+	dirtySections = ALL_MESH_SECTIONS;
+	meshJobId = 0;
+	state = GENERATING_STATE;
+	trees.clear();
+	left = nullptr;
+	right = nullptr;
+	front = nullptr;
+	back = nullptr;
+
+	// Keeps the capacity and the GL buffers, an empty mesh isn't drawn
 	mesh.vertices.clear();
 	waterMesh.vertices.clear();
 	transparentMesh.vertices.clear();
+	std::fill(&vertexEnds[0][0], &vertexEnds[0][0] + CHUNK_SECTION_COUNT * MESH_PART_COUNT, 0);
+	std::fill(&waterEnds[0][0], &waterEnds[0][0] + CHUNK_SECTION_COUNT * MESH_PART_COUNT, 0);
+	std::fill(&transparentEnds[0][0], &transparentEnds[0][0] + CHUNK_SECTION_COUNT * MESH_PART_COUNT, 0);
+}
 
-	for (int x = 0; x < CHUNK_SIZE; ++x)
+#pragma endregion
+
+#pragma region CHUNK_POOL
+
+Chunk* ChunkPool::acquire()
+{
+	if (freeChunks.empty())
 	{
-		for (int z = 0; z < CHUNK_SIZE; ++z)
-		{
-			for (int y = 0; y < CHUNK_SIZE_VERTICAL; ++y)
-			{
-				BlockData currentBlock = get_block_at(x, y, z);
-				if (!currentBlock) continue;  // Skip empty blocks
-
-				bool isWaterBlock = (currentBlock == WATER_BLOCK);
-				Mesh& targetMesh = isWaterBlock ? waterMesh : mesh;
-				BlockCategory blockType = get_block_category(currentBlock);
-				MeshType blockMeshType = get_block_mesh(currentBlock);
-
-				if (blockMeshType == CROSS_MESH)
-				{
-					PackedVertexData newVertex1 = { 0 };
-					PackedVertexData newVertex2 = { 0 };
-					PackedVertexData newVertex3 = { 0 };
-					PackedVertexData newVertex4 = { 0 };
-
-					PackedVertexData newVertex5 = { 0 };
-					PackedVertexData newVertex6 = { 0 };
-					PackedVertexData newVertex7 = { 0 };
-					PackedVertexData newVertex8 = { 0 };
-
-					VertexData vertex1 = cube[0];
-					VertexData vertex2 = cube[6 + 1];
-					VertexData vertex3 = cube[1 ];
-					VertexData vertex4 = cube[6+2];
-
-					VertexData vertex5 = cube[2];
-					VertexData vertex6 = cube[6 + 4];
-					VertexData vertex7 = cube[2+2];
-					VertexData vertex8 = cube[6 + 0];
-
-					set_position(newVertex1, (vertex1.position) + glm::vec3(x, y, z));
-					set_position(newVertex2, (vertex2.position) + glm::vec3(x, y, z));
-					set_position(newVertex3, (vertex3.position) + glm::vec3(x, y, z));
-					set_position(newVertex4, (vertex4.position) + glm::vec3(x, y, z));
-
-					set_position(newVertex5, (vertex5.position) + glm::vec3(x, y, z));
-					set_position(newVertex6, (vertex6.position) + glm::vec3(x, y, z));
-					set_position(newVertex7, (vertex7.position) + glm::vec3(x, y, z));
-					set_position(newVertex8, (vertex8.position) + glm::vec3(x, y, z));
-
-					newVertex1.textureID = get_block_textureID(currentBlock).x;
-					newVertex2.textureID = get_block_textureID(currentBlock).x;
-					newVertex3.textureID = get_block_textureID(currentBlock).x;
-					newVertex4.textureID = get_block_textureID(currentBlock).x;
-
-					newVertex5.textureID = get_block_textureID(currentBlock).x;
-					newVertex6.textureID = get_block_textureID(currentBlock).x;
-					newVertex7.textureID = get_block_textureID(currentBlock).x;
-					newVertex8.textureID = get_block_textureID(currentBlock).x;
-
-					newVertex1.uv = 0;
-					newVertex2.uv = 2;
-					newVertex3.uv = 1;
-					newVertex4.uv = 3;
-
-					newVertex5.uv = 1;
-					newVertex6.uv = 3;
-					newVertex7.uv = 0;
-					newVertex8.uv = 2;
-
-					set_AO(newVertex1, 3);
-					set_AO(newVertex2, 3);
-					set_AO(newVertex3, 3);
-					set_AO(newVertex4, 3);
-
-					set_AO(newVertex5, 3);
-					set_AO(newVertex6, 3);
-					set_AO(newVertex7, 3);
-					set_AO(newVertex8, 3);
-
-					transparentMesh.vertices.push_back(newVertex1);
-					transparentMesh.vertices.push_back(newVertex2);
-					transparentMesh.vertices.push_back(newVertex3);
-					transparentMesh.vertices.push_back(newVertex2);
-					transparentMesh.vertices.push_back(newVertex3);
-					transparentMesh.vertices.push_back(newVertex4);
-
-					transparentMesh.vertices.push_back(newVertex5);
-					transparentMesh.vertices.push_back(newVertex6);
-					transparentMesh.vertices.push_back(newVertex7);
-					transparentMesh.vertices.push_back(newVertex6);
-					transparentMesh.vertices.push_back(newVertex7);
-					transparentMesh.vertices.push_back(newVertex8);
-
-				}
-
-				else
-				{
-
-
-					for (unsigned face = 0; face < 6; ++face)
-					{
-						glm::vec3 neighborPos = glm::vec3(x, y, z) + offsets[face];
-						BlockData neighborBlock = get_block_at(neighborPos.x, neighborPos.y, neighborPos.z);
-						BlockCategory neighborBlockType = get_block_category(neighborBlock);
-
-						// Skip the face if a neighboring block exists. 
-						// For non solid blocks, skip the face if any neighboring block is present.
-						// For solid blocks, skip the face if the neighboring block is solid.
-						if (neighborBlock && ((blockType != SOLID) || neighborBlockType == SOLID))
-							continue;
-
-						glm::vec3 textureID = get_block_textureID(currentBlock);
-						for (unsigned vertex = 0; vertex < 6; ++vertex)
-						{
-							PackedVertexData newVertex = { 0 };
-							VertexData vertexData = cube[face * 6 + vertex];
-
-							set_position(newVertex, (vertexData.position + glm::vec3(x, y, z)));
-
-							// Assign textureID based on the face direction
-							newVertex.textureID = offsets[face].x != 0 ? textureID.x :
-								offsets[face].y != 0 ? textureID.y :
-								textureID.z;
-
-							glm::vec2 uv = vertexData.texCoords;
-							newVertex.uv = (uv == glm::vec2(1, 1)) ? 3 :
-								(uv == glm::vec2(1, 0)) ? 2 :
-								(uv == glm::vec2(0, 1)) ? 1 : 0;
-
-							if (!isWaterBlock)
-							{
-								// Calculate ambient oclusion if not a water block 
-								// https://0fps.net/2013/07/03/ambient-occlusion-for-minecraft-like-worlds/
-
-								glm::vec3 sideOffset1 = sideOffsets[face / 2][0];
-								glm::vec3 sideOffset2 = sideOffsets[face / 2][1];
-								glm::vec3 multiplier = glm::vec3(-1);
-								if (vertexData.position.x == 1) multiplier.x = 1;
-								if (vertexData.position.y == 1) multiplier.y = 1;
-								if (vertexData.position.z == 1) multiplier.z = 1;
-
-								glm::vec3 side1 = sideOffset1 * multiplier + glm::vec3(x, y, z) + offsets[face];
-								glm::vec3 side2 = sideOffset2 * multiplier + glm::vec3(x, y, z) + offsets[face];
-								glm::vec3 corner = (sideOffset1 + sideOffset2) * multiplier + glm::vec3(x, y, z) + offsets[face];
-
-								bool blockSide1 = (get_block_at(side1.x, side1.y, side1.z) && get_block_category(get_block_at(side1.x, side1.y, side1.z)) == SOLID);
-								bool blockSide2 = (get_block_at(side2.x, side2.y, side2.z) && get_block_category(get_block_at(side2.x, side2.y, side2.z)) == SOLID);
-								bool blockCorner = (get_block_at(corner.x, corner.y, corner.z) && get_block_category(get_block_at(corner.x, corner.y, corner.z)) == SOLID);
-
-								set_AO(newVertex, calculate_AO(blockSide1, blockSide2, blockCorner));
-							}
-							else
-							{
-								set_AO(newVertex, 3.f); // Flat AO for water blocks
-							}
-
-							set_normal(newVertex, vertexData.normal);
-							targetMesh.vertices.push_back(newVertex);
-						}
-					}
-				}
-			}
-		}
+		allocatedChunks++;
+		return new Chunk();
 	}
 
-	mesh.setup();
-	waterMesh.setup();
-	transparentMesh.setup();
-	dirty = false;
+	Chunk* chunk = freeChunks.back();
+	freeChunks.pop_back();
+	return chunk;
 }
 
-#pragma endregion
\ No newline at end of file
+void ChunkPool::release(Chunk* chunk)
+{
+	chunk->reset();
+	freeChunks.push_back(chunk);
+}
+
+void ChunkPool::clear()
+{
+	for (Chunk* chunk : freeChunks)
+	{
+		chunk->mesh.clear();
+		chunk->waterMesh.clear();
+		chunk->transparentMesh.clear();
+		delete chunk;
+	}
+	allocatedChunks -= freeChunks.size();
+	freeChunks.clear();
+}
+
+#pragma endregion
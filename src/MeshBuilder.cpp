@@ -0,0 +1,730 @@
+#include "MeshBuilder.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "Cube.h"
+
+#pragma region STATIC_FUNCTIONS
+
+static const glm::vec3 faceOffsets[] = {
+	{0, 0, -1},  // back face
+	{0, 0, 1},   // front face
+	{-1, 0, 0},  // left face
+	{1, 0, 0},   // right face
+	{0, -1, 0},  // bottom face
+	{0, 1, 0}    // top face
+};
+
+// Abs value of relative positions of blocks used to calculate ambient oclusion for each vertex
+static const glm::vec3 sideOffsets[3][2] = {
+	{{1,0,0}, {0,1,0}},
+	{{0, 1,0}, {0,0,1}},
+	{{1,0,0}, {0,0,1}}
+};
+
+// Set on greedy meshing face keys that belong to the water mesh
+static const uint32_t FACE_KEY_WATER = 1 << 10;
+// Set on greedy meshing face keys that can't be merged with any other face
+static const uint32_t FACE_KEY_SINGLE = 1 << 11;
+static const uint32_t FACE_KEY_VALID = 1 << 12;
+
+static int calculate_AO(bool side1, bool side2, bool corner) {
+	if (side1 && side2) return 0;
+	return 3 - (side1 + side2 + corner);
+}
+
+static uint8_t get_face_textureID(glm::vec3 textureID, unsigned face)
+{
+	// Assign textureID based on the face direction
+	return faceOffsets[face].x != 0 ? textureID.x :
+		faceOffsets[face].y != 0 ? textureID.y :
+		textureID.z;
+}
+
+// Skip the face if a neighboring block exists. 
+// For non solid blocks, skip the face if any neighboring block is present.
+// For solid blocks, skip the face if the neighboring block is solid.
+static bool is_face_visible(BlockData block, BlockData neighborBlock)
+{
+	return !(neighborBlock && ((get_block_category(block) != SOLID) || get_block_category(neighborBlock) == SOLID));
+}
+
+// Calculate ambient oclusion for the vertex cube[face * 6 + vertex] of the block at blockPos
+// https://0fps.net/2013/07/03/ambient-occlusion-for-minecraft-like-worlds/
+static int calculate_vertex_AO(const ChunkSnapshot& snapshot, unsigned face, unsigned vertex, glm::vec3 blockPos)
+{
+	VertexData vertexData = cube[face * 6 + vertex];
+
+	glm::vec3 sideOffset1 = sideOffsets[face / 2][0];
+	glm::vec3 sideOffset2 = sideOffsets[face / 2][1];
+	glm::vec3 multiplier = glm::vec3(-1);
+	if (vertexData.position.x == 1) multiplier.x = 1;
+	if (vertexData.position.y == 1) multiplier.y = 1;
+	if (vertexData.position.z == 1) multiplier.z = 1;
+
+	glm::vec3 side1 = sideOffset1 * multiplier + blockPos + faceOffsets[face];
+	glm::vec3 side2 = sideOffset2 * multiplier + blockPos + faceOffsets[face];
+	glm::vec3 corner = (sideOffset1 + sideOffset2) * multiplier + blockPos + faceOffsets[face];
+
+	BlockData side1Block = snapshot.get_block(side1.x, side1.y, side1.z);
+	BlockData side2Block = snapshot.get_block(side2.x, side2.y, side2.z);
+	BlockData cornerBlock = snapshot.get_block(corner.x, corner.y, corner.z);
+
+	bool blockSide1 = side1Block && get_block_category(side1Block) == SOLID;
+	bool blockSide2 = side2Block && get_block_category(side2Block) == SOLID;
+	bool blockCorner = cornerBlock && get_block_category(cornerBlock) == SOLID;
+
+	return calculate_AO(blockSide1, blockSide2, blockCorner);
+}
+
+// Relative positions of the blocks used to calculate ambient oclusion for every vertex of the cube,
+// the same offsets calculate_vertex_AO works out, as integers for the column mask lookups
+struct AOOffsets
+{
+	glm::ivec3 side1, side2, corner;
+};
+
+static const std::array<AOOffsets, 36> aoOffsets = []()
+{
+	std::array<AOOffsets, 36> offsets;
+	for (unsigned face = 0; face < 6; ++face)
+	{
+		for (unsigned vertex = 0; vertex < 6; ++vertex)
+		{
+			VertexData vertexData = cube[face * 6 + vertex];
+			glm::vec3 multiplier = glm::vec3(-1);
+			if (vertexData.position.x == 1) multiplier.x = 1;
+			if (vertexData.position.y == 1) multiplier.y = 1;
+			if (vertexData.position.z == 1) multiplier.z = 1;
+
+			glm::vec3 sideOffset1 = sideOffsets[face / 2][0] * multiplier;
+			glm::vec3 sideOffset2 = sideOffsets[face / 2][1] * multiplier;
+			offsets[face * 6 + vertex].side1 = glm::ivec3(sideOffset1 + faceOffsets[face]);
+			offsets[face * 6 + vertex].side2 = glm::ivec3(sideOffset2 + faceOffsets[face]);
+			offsets[face * 6 + vertex].corner = glm::ivec3(sideOffset1 + sideOffset2 + faceOffsets[face]);
+		}
+	}
+	return offsets;
+}();
+
+static int padded_index(int x, int z)
+{
+	return (x + 1) + (z + 1) * PADDED_CHUNK_SIZE;
+}
+
+static bool test_bit(const ColumnMask& mask, int y)
+{
+	if ((unsigned)y >= CHUNK_SIZE_VERTICAL) return false;
+	return (mask.words[y / 64] >> (y % 64)) & 1;
+}
+
+// Bit y of the result is bit y + 1 of the mask
+static ColumnMask shift_down(const ColumnMask& mask)
+{
+	ColumnMask result;
+	for (int i = 0; i < COLUMN_WORDS; ++i)
+	{
+		uint64_t carry = (i + 1 < COLUMN_WORDS) ? mask.words[i + 1] << 63 : 0;
+		result.words[i] = (mask.words[i] >> 1) | carry;
+	}
+	return result;
+}
+
+// Bit y of the result is bit y - 1 of the mask
+static ColumnMask shift_up(const ColumnMask& mask)
+{
+	ColumnMask result;
+	for (int i = 0; i < COLUMN_WORDS; ++i)
+	{
+		uint64_t carry = (i > 0) ? mask.words[i - 1] >> 63 : 0;
+		result.words[i] = (mask.words[i] << 1) | carry;
+	}
+	return result;
+}
+
+static const std::array<bool, BLOCK_TYPE_COUNT> solidBlocks = []()
+{
+	std::array<bool, BLOCK_TYPE_COUNT> solid = {};
+	for (int block = 0; block < BLOCK_TYPE_COUNT; ++block)
+	{
+		solid[block] = block != AIR_BLOCK && get_block_category((BlockType)block) == SOLID;
+	}
+	return solid;
+}();
+
+static void set_block_bits(ColumnMask& solid, ColumnMask& nonAir, ColumnMask& water, int y, BlockData block)
+{
+	solid.words[y / 64] |= (uint64_t)solidBlocks[block] << (y % 64);
+	nonAir.words[y / 64] |= (uint64_t)(block != AIR_BLOCK) << (y % 64);
+	water.words[y / 64] |= (uint64_t)(block == WATER_BLOCK) << (y % 64);
+}
+
+// Sets the bits of a whole uniform section at once, a section never straddles two words
+static void set_section_bits(ColumnMask& solid, ColumnMask& nonAir, ColumnMask& water, int section, BlockData block)
+{
+	const uint64_t sectionBits = (uint64_t(1) << CHUNK_SECTION_HEIGHT) - 1;
+	int word = section * CHUNK_SECTION_HEIGHT / 64;
+	int shift = section * CHUNK_SECTION_HEIGHT % 64;
+	if (solidBlocks[block]) solid.words[word] |= sectionBits << shift;
+	if (block != AIR_BLOCK) nonAir.words[word] |= sectionBits << shift;
+	if (block == WATER_BLOCK) water.words[word] |= sectionBits << shift;
+}
+
+// Builds the masks of the region and the columns around it. Faces and ambient occlusion only depend on
+// the blocks next to them, so only the sections being built and the ones above and below are filled in
+static void build_chunk_masks(const ChunkSnapshot& snapshot, const ColumnRegion& region, uint16_t sections, ChunkMasks& masks)
+{
+	uint16_t maskSections = sections | (sections << 1) | (sections >> 1);
+	masks.maxHeight = 0;
+	for (int z = region.minZ - 1; z <= region.maxZ; ++z)
+	{
+		for (int x = region.minX - 1; x <= region.maxX; ++x)
+		{
+			ColumnMask& solid = masks.solid[padded_index(x, z)];
+			ColumnMask& nonAir = masks.nonAir[padded_index(x, z)];
+			solid = {};
+			nonAir = {};
+			ColumnMask water = {};
+
+			// Border columns from the neighbours, the diagonal ones only matter for ambient occlusion
+			const BlockData* column = snapshot.get_column(x, z);
+			if (x < 0 || x >= CHUNK_SIZE || z < 0 || z >= CHUNK_SIZE)
+			{
+				for (int section = 0; section < CHUNK_SECTION_COUNT; ++section)
+				{
+					if (!(maskSections & (1 << section))) continue;
+					for (int y = section * CHUNK_SECTION_HEIGHT; y < (section + 1) * CHUNK_SECTION_HEIGHT; ++y) set_block_bits(solid, nonAir, water, y, column[y]);
+				}
+				continue;
+			}
+
+			for (int section = 0; section < CHUNK_SECTION_COUNT; ++section)
+			{
+				if (!(maskSections & (1 << section))) continue;
+				int sectionY = section * CHUNK_SECTION_HEIGHT;
+				if (snapshot.isUniform[section])
+				{
+					BlockData block = snapshot.uniformBlocks[section];
+					set_section_bits(solid, nonAir, water, section, block);
+					if (solidBlocks[block] || block == WATER_BLOCK) masks.maxHeight = std::max(masks.maxHeight, sectionY + CHUNK_SECTION_HEIGHT);
+					continue;
+				}
+
+				for (int y = sectionY; y < sectionY + CHUNK_SECTION_HEIGHT; ++y)
+				{
+					set_block_bits(solid, nonAir, water, y, column[y]);
+					if (solidBlocks[column[y]] || column[y] == WATER_BLOCK) masks.maxHeight = std::max(masks.maxHeight, y + 1);
+				}
+			}
+			masks.water[x + z * CHUNK_SIZE] = water;
+		}
+	}
+}
+
+// Cube faces of the column (x, z) that aren't covered by the neighbouring block in the face direction.
+// Solid blocks are covered by solid neighbours, water is covered by any neighbour (see is_face_visible)
+static ColumnMask get_visible_faces(const ChunkMasks& masks, int x, int z, unsigned face)
+{
+	const ColumnMask& solid = masks.solid[padded_index(x, z)];
+	const ColumnMask& water = masks.water[x + z * CHUNK_SIZE];
+
+	ColumnMask neighborSolid, neighborNonAir;
+	if (face == 4) // bottom face
+	{
+		neighborSolid = shift_up(solid);
+		neighborNonAir = shift_up(masks.nonAir[padded_index(x, z)]);
+	}
+	else if (face == 5) // top face
+	{
+		neighborSolid = shift_down(solid);
+		neighborNonAir = shift_down(masks.nonAir[padded_index(x, z)]);
+	}
+	else
+	{
+		int neighbor = padded_index(x + (int)faceOffsets[face].x, z + (int)faceOffsets[face].z);
+		neighborSolid = masks.solid[neighbor];
+		neighborNonAir = masks.nonAir[neighbor];
+	}
+
+	ColumnMask visible;
+	for (int i = 0; i < COLUMN_WORDS; ++i)
+	{
+		visible.words[i] = (solid.words[i] & ~neighborSolid.words[i]) | (water.words[i] & ~neighborNonAir.words[i]);
+	}
+	return visible;
+}
+
+static bool is_solid_at(const ChunkMasks& masks, glm::ivec3 pos)
+{
+	return test_bit(masks.solid[padded_index(pos.x, pos.z)], pos.y);
+}
+
+static int calculate_vertex_AO(const ChunkMasks& masks, unsigned face, unsigned vertex, glm::ivec3 blockPos)
+{
+	const AOOffsets& offsets = aoOffsets[face * 6 + vertex];
+	return calculate_AO(is_solid_at(masks, blockPos + offsets.side1), is_solid_at(masks, blockPos + offsets.side2), is_solid_at(masks, blockPos + offsets.corner));
+}
+
+static void add_cross_mesh(std::vector<PackedVertexData>& targetVertices, BlockData block, glm::vec3 blockPos)
+{
+	// Two diagonal quads, built from the corners of the back and front faces
+	const unsigned cornerVertices[8] = { 0, 6 + 1, 1, 6 + 2, 2, 6 + 4, 2 + 2, 6 + 0 };
+	const char cornerUVs[8] = { 0, 2, 1, 3, 1, 3, 0, 2 };
+	const unsigned quadOrder[6] = { 0, 1, 2, 1, 2, 3 };
+
+	PackedVertexData vertices[8];
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		vertices[i] = { 0 };
+		set_position(vertices[i], cube[cornerVertices[i]].position + blockPos);
+		vertices[i].textureID = get_block_textureID(block).x;
+		vertices[i].uv = cornerUVs[i];
+		set_AO(vertices[i], 3);
+	}
+
+	for (unsigned quad = 0; quad < 2; ++quad)
+	{
+		for (unsigned i = 0; i < 6; ++i)
+		{
+			targetVertices.push_back(vertices[quad * 4 + quadOrder[i]]);
+		}
+	}
+}
+
+// Adds the flowers of every column in the sections being built, they are the only blocks that are neither solid nor water
+static void add_cross_meshes(SectionVertices* sectionVertices, const ChunkSnapshot& snapshot, const ChunkMasks& masks, const ColumnMask& sectionMask, const ColumnRegion& region)
+{
+	for (int z = region.minZ; z < region.maxZ; ++z)
+	{
+		for (int x = region.minX; x < region.maxX; ++x)
+		{
+			const ColumnMask& solid = masks.solid[padded_index(x, z)];
+			const ColumnMask& nonAir = masks.nonAir[padded_index(x, z)];
+			const ColumnMask& water = masks.water[x + z * CHUNK_SIZE];
+
+			for (int i = 0; i < COLUMN_WORDS; ++i)
+			{
+				uint64_t bits = nonAir.words[i] & ~solid.words[i] & ~water.words[i] & sectionMask.words[i];
+				while (bits)
+				{
+					int y = i * 64 + std::countr_zero(bits);
+					bits &= bits - 1;
+					add_cross_mesh(sectionVertices[y / CHUNK_SECTION_HEIGHT].transparentVertices, snapshot.get_block(x, y, z), glm::vec3(x, y, z));
+				}
+			}
+		}
+	}
+}
+
+// Emit a face of size quadSize (1 along the face normal) starting at the block blockPos.
+// The uv is flagged as tiled so the shaders repeat the texture once per block across the quad
+static void add_face_quad(std::vector<PackedVertexData>& targetVertices, unsigned face, glm::vec3 blockPos, glm::vec3 quadSize, uint8_t textureID, uint8_t ao)
+{
+	for (unsigned vertex = 0; vertex < 6; ++vertex)
+	{
+		PackedVertexData newVertex = { 0 };
+		VertexData vertexData = cube[face * 6 + vertex];
+
+		set_position(newVertex, vertexData.position * quadSize + blockPos);
+		newVertex.textureID = textureID;
+		newVertex.uv = TILED_UV;
+		set_AO(newVertex, ao);
+		set_normal(newVertex, vertexData.normal);
+		targetVertices.push_back(newVertex);
+	}
+}
+
+// Emit a single block face, with the ambient occlusion calculated for every vertex
+static void add_block_face(std::vector<PackedVertexData>& targetVertices, const ChunkMasks& masks, unsigned face, glm::ivec3 blockPos, uint8_t textureID, bool isWaterBlock)
+{
+	for (unsigned vertex = 0; vertex < 6; ++vertex)
+	{
+		PackedVertexData newVertex = { 0 };
+		VertexData vertexData = cube[face * 6 + vertex];
+
+		set_position(newVertex, vertexData.position + glm::vec3(blockPos));
+		newVertex.textureID = textureID;
+
+		glm::vec2 uv = vertexData.texCoords;
+		newVertex.uv = (uv == glm::vec2(1, 1)) ? 3 :
+			(uv == glm::vec2(1, 0)) ? 2 :
+			(uv == glm::vec2(0, 1)) ? 1 : 0;
+
+		// Flat AO for water blocks
+		set_AO(newVertex, isWaterBlock ? 3 : calculate_vertex_AO(masks, face, vertex, blockPos));
+		set_normal(newVertex, vertexData.normal);
+		targetVertices.push_back(newVertex);
+	}
+}
+
+// Returns the greedy meshing key of a visible face, faces are only merged if their keys are equal.
+static uint32_t get_face_key(const ChunkSnapshot& snapshot, const ChunkMasks& masks, unsigned face, glm::ivec3 blockPos)
+{
+	BlockData block = snapshot.get_block(blockPos.x, blockPos.y, blockPos.z);
+	uint8_t textureID = get_face_textureID(get_block_textureID(block), face);
+
+	if (block == WATER_BLOCK) return FACE_KEY_VALID | FACE_KEY_WATER | (3 << 8) | textureID;
+
+	// Faces whose vertices have different AO values are shaded by interpolating between them,
+	// merging those would stretch the gradient across the whole quad, so they are emitted on their own
+	int ao = calculate_vertex_AO(masks, face, 0, blockPos);
+	for (unsigned vertex = 1; vertex < 6; ++vertex)
+	{
+		if (calculate_vertex_AO(masks, face, vertex, blockPos) != ao) return FACE_KEY_VALID | FACE_KEY_SINGLE | textureID;
+	}
+
+	return FACE_KEY_VALID | (ao << 8) | textureID;
+}
+
+#pragma endregion
+
+#pragma region CHUNK_SNAPSHOT
+
+void ChunkSnapshot::copy_from(const Chunk& chunk)
+{
+	for (int section = 0; section < CHUNK_SECTION_COUNT; ++section)
+	{
+		isUniform[section] = chunk.sections[section].is_uniform();
+		uniformBlocks[section] = chunk.sections[section].uniformBlock;
+	}
+
+	// Indexed by the side of the chunk the column is on, the diagonal neighbours are found through either side
+	const Chunk* sources[3][3] = {
+		{ chunk.back ? chunk.back->left : chunk.left ? chunk.left->back : nullptr, chunk.back, chunk.back ? chunk.back->right : chunk.right ? chunk.right->back : nullptr },
+		{ chunk.left, &chunk, chunk.right },
+		{ chunk.front ? chunk.front->left : chunk.left ? chunk.left->front : nullptr, chunk.front, chunk.front ? chunk.front->right : chunk.right ? chunk.right->front : nullptr },
+	};
+
+	for (int z = -1; z <= CHUNK_SIZE; ++z)
+	{
+		for (int x = -1; x <= CHUNK_SIZE; ++x)
+		{
+			int sideX = x < 0 ? -1 : x < CHUNK_SIZE ? 0 : 1;
+			int sideZ = z < 0 ? -1 : z < CHUNK_SIZE ? 0 : 1;
+			const Chunk* source = sources[sideZ + 1][sideX + 1];
+
+			BlockData* column = &blocks[get_padded_block_index(x, -1, z)];
+			column[0] = AIR_BLOCK;
+			column[PADDED_COLUMN_HEIGHT - 1] = AIR_BLOCK;
+			if (source == nullptr)
+			{
+				std::fill(column + 1, column + 1 + CHUNK_SIZE_VERTICAL, AIR_BLOCK);
+				continue;
+			}
+
+			// Same as ChunkSection::copy_column, inlined since this runs for every column of every mesh
+			int sourceIndex = get_section_block_index(x - sideX * CHUNK_SIZE, 0, z - sideZ * CHUNK_SIZE);
+			for (int section = 0; section < CHUNK_SECTION_COUNT; ++section)
+			{
+				const ChunkSection& sourceSection = source->sections[section];
+				BlockData* target = column + 1 + section * CHUNK_SECTION_HEIGHT;
+				if (sourceSection.is_uniform()) memset(target, sourceSection.uniformBlock, CHUNK_SECTION_HEIGHT);
+				else memcpy(target, &sourceSection.blocks[sourceIndex], CHUNK_SECTION_HEIGHT);
+			}
+		}
+	}
+}
+
+#pragma endregion
+
+#pragma region MESH_BUILDER
+
+static ColumnRegion get_part_region(MeshPart part)
+{
+	switch (part)
+	{
+	case LEFT_PART: return { 0, 0, 1, CHUNK_SIZE };
+	case RIGHT_PART: return { CHUNK_SIZE - 1, 0, CHUNK_SIZE, CHUNK_SIZE };
+	case BACK_PART: return { 1, 0, CHUNK_SIZE - 1, 1 };
+	case FRONT_PART: return { 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1, CHUNK_SIZE };
+	default: return { 1, 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1 };
+	}
+}
+
+void MeshBuilder::build(const ChunkSnapshot& snapshot, MeshingMode mode, uint8_t parts, uint16_t sections, ChunkMeshData& meshData)
+{
+	meshData.vertices.clear();
+	meshData.waterVertices.clear();
+	meshData.transparentVertices.clear();
+	meshData.parts = parts;
+	meshData.sections = sections;
+
+	this->sections = sections;
+	sectionMask = {};
+	for (int section = 0; section < CHUNK_SECTION_COUNT; ++section)
+	{
+		sectionVertices[section].vertices.clear();
+		sectionVertices[section].waterVertices.clear();
+		sectionVertices[section].transparentVertices.clear();
+		if (sections & (1 << section))
+		{
+			const uint64_t sectionBits = (uint64_t(1) << CHUNK_SECTION_HEIGHT) - 1;
+			sectionMask.words[section * CHUNK_SECTION_HEIGHT / 64] |= sectionBits << (section * CHUNK_SECTION_HEIGHT % 64);
+		}
+	}
+
+	// A whole chunk builds its masks once, single parts only around themselves
+	bool hasMasks = parts == ALL_MESH_PARTS && mode != PER_FACE_MESHING;
+	if (hasMasks) build_chunk_masks(snapshot, { 0, 0, CHUNK_SIZE, CHUNK_SIZE }, sections, masks);
+
+	for (int part = 0; part < MESH_PART_COUNT; ++part)
+	{
+		if (parts & (1 << part))
+		{
+			ColumnRegion region = get_part_region((MeshPart)part);
+			if (!hasMasks && mode != PER_FACE_MESHING) build_chunk_masks(snapshot, region, sections, masks);
+
+			if (mode == GREEDY_MESHING) build_greedy_mesh(snapshot, region);
+			else if (mode == BINARY_MESHING) build_binary_mesh(snapshot, region);
+			else build_per_face_mesh(snapshot, region);
+		}
+
+		// Where the part ends in every section, the section's start is added when they're joined
+		for (int section = 0; section < CHUNK_SECTION_COUNT; ++section)
+		{
+			meshData.vertexEnds[section][part] = (uint32_t)sectionVertices[section].vertices.size();
+			meshData.waterEnds[section][part] = (uint32_t)sectionVertices[section].waterVertices.size();
+			meshData.transparentEnds[section][part] = (uint32_t)sectionVertices[section].transparentVertices.size();
+		}
+	}
+
+	for (int section = 0; section < CHUNK_SECTION_COUNT; ++section)
+	{
+		uint32_t start = (uint32_t)meshData.vertices.size();
+		uint32_t waterStart = (uint32_t)meshData.waterVertices.size();
+		uint32_t transparentStart = (uint32_t)meshData.transparentVertices.size();
+		const SectionVertices& built = sectionVertices[section];
+		meshData.vertices.insert(meshData.vertices.end(), built.vertices.begin(), built.vertices.end());
+		meshData.waterVertices.insert(meshData.waterVertices.end(), built.waterVertices.begin(), built.waterVertices.end());
+		meshData.transparentVertices.insert(meshData.transparentVertices.end(), built.transparentVertices.begin(), built.transparentVertices.end());
+		for (int part = 0; part < MESH_PART_COUNT; ++part)
+		{
+			meshData.vertexEnds[section][part] += start;
+			meshData.waterEnds[section][part] += waterStart;
+			meshData.transparentEnds[section][part] += transparentStart;
+		}
+	}
+}
+
+void MeshBuilder::build_per_face_mesh(const ChunkSnapshot& snapshot, const ColumnRegion& region)
+{
+	for (int x = region.minX; x < region.maxX; ++x)
+	{
+		for (int z = region.minZ; z < region.maxZ; ++z)
+		{
+			for (int y = 0; y < CHUNK_SIZE_VERTICAL; ++y)
+			{
+				if (!(sections & (1 << (y / CHUNK_SECTION_HEIGHT)))) continue;
+				BlockData currentBlock = snapshot.get_block(x, y, z);
+				if (!currentBlock) continue;  // Skip empty blocks
+
+				bool isWaterBlock = (currentBlock == WATER_BLOCK);
+				SectionVertices& section = sectionVertices[y / CHUNK_SECTION_HEIGHT];
+				std::vector<PackedVertexData>& targetVertices = isWaterBlock ? section.waterVertices : section.vertices;
+
+				if (get_block_mesh(currentBlock) == CROSS_MESH)
+				{
+					add_cross_mesh(section.transparentVertices, currentBlock, glm::vec3(x, y, z));
+					continue;
+				}
+
+				for (unsigned face = 0; face < 6; ++face)
+				{
+					glm::vec3 neighborPos = glm::vec3(x, y, z) + faceOffsets[face];
+					BlockData neighborBlock = snapshot.get_block(neighborPos.x, neighborPos.y, neighborPos.z);
+					if (!is_face_visible(currentBlock, neighborBlock)) continue;
+
+					glm::vec3 textureID = get_block_textureID(currentBlock);
+					for (unsigned vertex = 0; vertex < 6; ++vertex)
+					{
+						PackedVertexData newVertex = { 0 };
+						VertexData vertexData = cube[face * 6 + vertex];
+
+						set_position(newVertex, (vertexData.position + glm::vec3(x, y, z)));
+						newVertex.textureID = get_face_textureID(textureID, face);
+
+						glm::vec2 uv = vertexData.texCoords;
+						newVertex.uv = (uv == glm::vec2(1, 1)) ? 3 :
+							(uv == glm::vec2(1, 0)) ? 2 :
+							(uv == glm::vec2(0, 1)) ? 1 : 0;
+
+						// Flat AO for water blocks
+						set_AO(newVertex, isWaterBlock ? 3 : calculate_vertex_AO(snapshot, face, vertex, glm::vec3(x, y, z)));
+
+						set_normal(newVertex, vertexData.normal);
+						targetVertices.push_back(newVertex);
+					}
+				}
+			}
+		}
+	}
+}
+
+// Per face meshing with the face culling done on whole columns at a time using bit operations
+void MeshBuilder::build_binary_mesh(const ChunkSnapshot& snapshot, const ColumnRegion& region)
+{
+	add_cross_meshes(sectionVertices, snapshot, masks, sectionMask, region);
+
+	for (int x = region.minX; x < region.maxX; ++x)
+	{
+		for (int z = region.minZ; z < region.maxZ; ++z)
+		{
+			for (unsigned face = 0; face < 6; ++face)
+			{
+				ColumnMask visible = get_visible_faces(masks, x, z, face);
+				for (int i = 0; i < COLUMN_WORDS; ++i)
+				{
+					uint64_t bits = visible.words[i] & sectionMask.words[i];
+					while (bits)
+					{
+						int y = i * 64 + std::countr_zero(bits);
+						bits &= bits - 1;
+
+						BlockData block = snapshot.get_block(x, y, z);
+						bool isWaterBlock = (block == WATER_BLOCK);
+						uint8_t textureID = get_face_textureID(get_block_textureID(block), face);
+						SectionVertices& section = sectionVertices[y / CHUNK_SECTION_HEIGHT];
+						add_block_face(isWaterBlock ? section.waterVertices : section.vertices, masks, face, glm::ivec3(x, y, z), textureID, isWaterBlock);
+					}
+				}
+			}
+		}
+	}
+}
+
+// Greedy meshing, merges coplanar faces with the same texture and AO into bigger quads
+// https://0fps.net/2012/06/30/meshing-in-a-minecraft-game/
+void MeshBuilder::build_greedy_mesh(const ChunkSnapshot& snapshot, const ColumnRegion& region)
+{
+	// Flowers aren't merged so they are added right away
+	add_cross_meshes(sectionVertices, snapshot, masks, sectionMask, region);
+
+	// Faces are only merged within the region and the section, so every part of every section can be built again on its own
+	const int start[3] = { region.minX, 0, region.minZ };
+	const int size[3] = { region.maxX - region.minX, CHUNK_SIZE_VERTICAL, region.maxZ - region.minZ };
+	const int maxHeight = std::min(masks.maxHeight, (int)std::bit_width(sections) * CHUNK_SECTION_HEIGHT);
+
+	for (unsigned face = 0; face < 6; ++face)
+	{
+		// Buried uniform sections have no visible faces, so everything below the lowest visible face is skipped
+		int minHeight = maxHeight;
+		for (int z = region.minZ; z < region.maxZ; ++z)
+		{
+			for (int x = region.minX; x < region.maxX; ++x)
+			{
+				ColumnMask& visible = visibleFaces[x + z * CHUNK_SIZE];
+				visible = get_visible_faces(masks, x, z, face);
+				for (int i = 0; i < COLUMN_WORDS; ++i) visible.words[i] &= sectionMask.words[i];
+				for (int i = 0; i < COLUMN_WORDS && i * 64 < minHeight; ++i)
+				{
+					if (visible.words[i] == 0) continue;
+					minHeight = std::min(minHeight, i * 64 + std::countr_zero(visible.words[i]));
+					break;
+				}
+			}
+		}
+
+		// d is the axis the face points along, u and v span the slice
+		const int d = faceOffsets[face].x != 0 ? 0 : faceOffsets[face].y != 0 ? 1 : 2;
+		const int u = d == 0 ? 2 : 0;
+		const int v = d == 1 ? 2 : 1;
+
+		// Nothing above the highest cube can produce a face, so slices past it are skipped
+		const int sliceStart = d == 1 ? minHeight : start[d];
+		const int sliceCount = d == 1 ? maxHeight : start[d] + size[d];
+		const int width = size[u];
+		const int rowStart = d == 1 ? 0 : minHeight;
+		const int height = d == 1 ? size[v] : maxHeight;
+
+		for (int slice = sliceStart; slice < sliceCount; ++slice)
+		{
+			// Build the mask of visible faces in this slice
+			for (int j = rowStart; j < height; ++j)
+			{
+				for (int i = 0; i < width; ++i)
+				{
+					glm::ivec3 blockPos;
+					blockPos[d] = slice;
+					blockPos[u] = start[u] + i;
+					blockPos[v] = start[v] + j;
+
+					bool isVisible = test_bit(visibleFaces[blockPos.x + blockPos.z * CHUNK_SIZE], blockPos.y);
+					faceMask[i + j * width] = isVisible ? get_face_key(snapshot, masks, face, blockPos) : 0;
+				}
+			}
+
+			// Merge matching faces, first along u and then along v
+			for (int j = rowStart; j < height; ++j)
+			{
+				for (int i = 0; i < width;)
+				{
+					uint32_t key = faceMask[i + j * width];
+					if (key == 0)
+					{
+						++i;
+						continue;
+					}
+
+					glm::ivec3 blockPos;
+					blockPos[d] = slice;
+					blockPos[u] = start[u] + i;
+					blockPos[v] = start[v] + j;
+
+					SectionVertices& section = sectionVertices[blockPos.y / CHUNK_SECTION_HEIGHT];
+					if (key & FACE_KEY_SINGLE)
+					{
+						add_block_face(section.vertices, masks, face, blockPos, key & 0xFF, false);
+						++i;
+						continue;
+					}
+
+					// The water shader displaces every vertex based on its x position, so water is never merged along x
+					bool canMergeAlongU = !((key & FACE_KEY_WATER) && u == 0);
+
+					int quadWidth = 1;
+					while (canMergeAlongU && i + quadWidth < width && faceMask[i + quadWidth + j * width] == key) ++quadWidth;
+
+					// Quads along y stop at the top of the section
+					int quadHeight = 1;
+					bool canExtend = true;
+					while (j + quadHeight < height && (v != 1 || (j + quadHeight) % CHUNK_SECTION_HEIGHT != 0) && canExtend)
+					{
+						for (int k = 0; k < quadWidth; ++k)
+						{
+							if (faceMask[i + k + (j + quadHeight) * width] != key)
+							{
+								canExtend = false;
+								break;
+							}
+						}
+						if (canExtend) ++quadHeight;
+					}
+
+					glm::vec3 quadSize = glm::vec3(1);
+					quadSize[u] = quadWidth;
+					quadSize[v] = quadHeight;
+
+					bool isWaterFace = key & FACE_KEY_WATER;
+					uint8_t textureID = key & 0xFF;
+					uint8_t ao = (key >> 8) & 0b11;
+					add_face_quad(isWaterFace ? section.waterVertices : section.vertices, face, glm::vec3(blockPos), quadSize, textureID, ao);
+
+					for (int l = 0; l < quadHeight; ++l)
+					{
+						for (int k = 0; k < quadWidth; ++k)
+						{
+							faceMask[i + k + (j + l) * width] = 0;
+						}
+					}
+
+					i += quadWidth;
+				}
+			}
+		}
+	}
+}
+
+#pragma endregion
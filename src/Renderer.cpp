@@ -368,7 +368,7 @@ void draw_mesh(const Mesh& mesh, const Shader &shader, const Camera& camera, glm
     view = camera.get_view();
 
     glm::mat4 projection = glm::mat4(1.0f);
-    projection = glm::perspective(glm::radians(camera.fov), 800.0f / 600.0f, 0.1f, 100000.0f);
+    projection = glm::perspective(glm::radians(camera.fov), ASPECT_RATIO, 0.1f, 100000.0f);
 
     glm::mat3 normalMat = glm::mat3(1.f);
     normalMat = glm::transpose(glm::inverse(view * model));
@@ -387,41 +387,64 @@ void draw_mesh(const Mesh& mesh, const Shader &shader, const Camera& camera, glm
     glDrawArrays(GL_TRIANGLES, 0, mesh.vertices.size());
 }
 
-void Mesh::setup()
+void Mesh::setup(size_t firstChanged)
 {
-    if (vertices.size() == 0)
-    {
-        Log_warn << "Tried to initialise mesh without vertices\n";
-        return;
-    }
+    if (vertices.size() == 0) return;
 
-    if (VAO != 0)
+    // The VAO and VBO are created once and kept when the mesh gets new vertices, only the buffer storage is replaced
+    if (VAO == 0)
     {
-        glDeleteVertexArrays(1, &VAO);
-    }
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
 
-    if (VBO != 0) glDeleteBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+        glEnableVertexAttribArray(0); // position
+        glVertexAttribPointer(0,3, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(PackedVertexData), (void*)offsetof(PackedVertexData, x));
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glEnableVertexAttribArray(1); // cube face
+        glVertexAttribPointer(1, 2, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(PackedVertexData), (void*)offsetof(PackedVertexData, face));
 
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(PackedVertexData), &vertices[0], GL_STATIC_DRAW);
+        glEnableVertexAttribArray(2); // texture coords
+        glVertexAttribPointer(2, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(PackedVertexData), (void*)offsetof(PackedVertexData, uv));
 
-    glEnableVertexAttribArray(0); // position
-    glVertexAttribPointer(0,3, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(PackedVertexData), (void*)offsetof(PackedVertexData, x));
+        glEnableVertexAttribArray(3); // texture id (in the atlas)
+        glVertexAttribPointer(3, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(PackedVertexData), (void*)offsetof(PackedVertexData, textureID));
+    }
+    else
+    {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    }
 
-    glEnableVertexAttribArray(1); // cube face
-    glVertexAttribPointer(1, 2, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(PackedVertexData), (void*)offsetof(PackedVertexData, face));
+    if (firstChanged > 0 && vertices.size() <= capacity)
+    {
+        if (firstChanged < vertices.size()) glBufferSubData(GL_ARRAY_BUFFER, firstChanged * sizeof(PackedVertexData), (vertices.size() - firstChanged) * sizeof(PackedVertexData), &vertices[firstChanged]);
+        return;
+    }
 
-    glEnableVertexAttribArray(2); // texture coords
-    glVertexAttribPointer(2, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(PackedVertexData), (void*)offsetof(PackedVertexData, uv));
+    // Meshes that are updated in place get some room to grow, so the next edits don't replace the storage
+    if (firstChanged > 0)
+    {
+        capacity = vertices.size() + vertices.size() / 8;
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(PackedVertexData), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(PackedVertexData), &vertices[0]);
+        return;
+    }
+    capacity = vertices.size();
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(PackedVertexData), &vertices[0], GL_STATIC_DRAW);
+}
 
-    glEnableVertexAttribArray(3); // texture id (in the atlas)
-    glVertexAttribPointer(3, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(PackedVertexData), (void*)offsetof(PackedVertexData, textureID));
+void Mesh::clear()
+{
+    if (VAO != 0) glDeleteVertexArrays(1, &VAO);
+    if (VBO != 0) glDeleteBuffers(1, &VBO);
+    VAO = 0;
+    VBO = 0;
+    capacity = 0;
 
+    std::vector<PackedVertexData>().swap(vertices);
 }
 
 void set_position(PackedVertexData &vertexData, glm::vec3 position)
@@ -0,0 +1,504 @@
+#include "TerrainGenerator.h"
+#include "Lanes.h"
+#include <algorithm>
+
+#pragma region SINE_TERRAIN
+
+static Lanes lanes_sin(Lanes angle)
+{
+	const float PI = 3.14159265358979f;
+
+	// Reduce to [-pi, pi], 2 pi is split in two parts so the reduction stays accurate for big angles
+	Lanes turns = lanes_round(lanes_mul(angle, lanes_set(1.0f / (2.0f * PI))));
+	Lanes x = lanes_sub(angle, lanes_mul(turns, lanes_set(6.28125f)));
+	x = lanes_sub(x, lanes_mul(turns, lanes_set(1.93530717958647692e-3f)));
+
+	// sin(x) = sin(pi - x), folds [-pi, pi] to [-pi/2, pi/2]
+	x = lanes_select(lanes_greater(x, lanes_set(PI / 2)), lanes_sub(lanes_set(PI), x), x);
+	x = lanes_select(lanes_greater(lanes_set(-PI / 2), x), lanes_sub(lanes_set(-PI), x), x);
+
+	// Taylor series up to x^11, the truncation error is below 6e-8 on [-pi/2, pi/2]
+	Lanes x2 = lanes_mul(x, x);
+	Lanes result = lanes_set(-1.0f / 39916800.0f);
+	result = lanes_add(lanes_mul(result, x2), lanes_set(1.0f / 362880.0f));
+	result = lanes_add(lanes_mul(result, x2), lanes_set(-1.0f / 5040.0f));
+	result = lanes_add(lanes_mul(result, x2), lanes_set(1.0f / 120.0f));
+	result = lanes_add(lanes_mul(result, x2), lanes_set(-1.0f / 6.0f));
+	return lanes_add(x, lanes_mul(lanes_mul(result, x2), x));
+}
+
+static Lanes lanes_cos(Lanes angle)
+{
+	return lanes_sin(lanes_add(angle, lanes_set(3.14159265358979f / 2)));
+}
+
+float fast_sin(float angle)
+{
+	float values[LANE_COUNT];
+	lanes_store(values, lanes_sin(lanes_set(angle)));
+	return values[0];
+}
+
+// amplitude * sin((position + offset) / period) for the 16 positions of a chunk row or column
+static void sine_term(const float* positions, float offset, float period, float amplitude, bool useCos, float* target)
+{
+	for (int i = 0; i < CHUNK_SIZE; i += LANE_COUNT)
+	{
+		Lanes angle = lanes_div(lanes_add(lanes_load(positions + i), lanes_set(offset)), lanes_set(period));
+		Lanes wave = useCos ? lanes_cos(angle) : lanes_sin(angle);
+		lanes_store(target + i, lanes_mul(wave, lanes_set(amplitude)));
+	}
+}
+
+void SineTerrainGenerator::generate_heightmap(int chunkX, int chunkZ, int heights[CHUNK_SIZE * CHUNK_SIZE]) const
+{
+	float worldX[CHUNK_SIZE], worldZ[CHUNK_SIZE];
+	for (int i = 0; i < CHUNK_SIZE; ++i)
+	{
+		worldX[i] = (float)(i + chunkX * CHUNK_SIZE);
+		worldZ[i] = (float)(i + chunkZ * CHUNK_SIZE);
+	}
+
+	// height = xWaves + zWaves + xRidges * zRidges + xBumps * zBumps
+	float xWaves[CHUNK_SIZE], zWaves[CHUNK_SIZE], xDetail[CHUNK_SIZE], zDetail[CHUNK_SIZE];
+	float xRidges[CHUNK_SIZE], zRidges[CHUNK_SIZE], xBumps[CHUNK_SIZE], zBumps[CHUNK_SIZE];
+	sine_term(worldX, 0, 40.0f, 50.0f, false, xWaves);
+	sine_term(worldX, 0, 3.0f, 4.0f, false, xDetail);
+	sine_term(worldZ, 0, 50.0f, 60.0f, false, zWaves);
+	sine_term(worldZ, 0, 3.0f, 4.0f, false, zDetail);
+	sine_term(worldX, 201, 16.0f, 5.0f, false, xRidges);
+	sine_term(worldZ, 420, 12.0f, 5.0f, true, zRidges);
+	sine_term(worldX, 469, 8.0f, 2.0f, false, xBumps);
+	sine_term(worldZ, 690, 8.0f, 2.0f, true, zBumps);
+	for (int i = 0; i < CHUNK_SIZE; ++i)
+	{
+		xWaves[i] += xDetail[i];
+		zWaves[i] += zDetail[i];
+	}
+
+	for (int z = 0; z < CHUNK_SIZE; ++z)
+	{
+		Lanes zWave = lanes_set(zWaves[z]);
+		Lanes zRidge = lanes_set(zRidges[z]);
+		Lanes zBump = lanes_set(zBumps[z]);
+		for (int x = 0; x < CHUNK_SIZE; x += LANE_COUNT)
+		{
+			Lanes height = lanes_add(lanes_load(xWaves + x), zWave);
+			height = lanes_add(height, lanes_mul(lanes_load(xRidges + x), zRidge));
+			height = lanes_add(height, lanes_mul(lanes_load(xBumps + x), zBump));
+
+			// Add an offset to the height
+			height = lanes_add(lanes_max(height, lanes_set(-32.0f)), lanes_set(64.0f));
+			int_lanes_store(heights + x + z * CHUNK_SIZE, lanes_to_int(height));
+		}
+	}
+}
+
+#pragma endregion
+
+#pragma region NOISE_TERRAIN
+
+static IntLanes hash_lattice(IntLanes x, IntLanes z, IntLanes seed)
+{
+	IntLanes hash = int_lanes_xor(int_lanes_mul(x, int_lanes_set(0x27d4eb2d)), int_lanes_mul(z, int_lanes_set(0x165667b1)));
+	hash = int_lanes_xor(hash, seed);
+	hash = int_lanes_mul(int_lanes_xor(hash, int_lanes_shift_right(hash, 15)), int_lanes_set(0x2c1b3c6d));
+	return int_lanes_xor(hash, int_lanes_shift_right(hash, 12));
+}
+
+// Dot product of (x, z) with one of the 8 gradients (+-1, +-2) and (+-2, +-1), picked by the hash
+static Lanes gradient_2d(IntLanes hash, Lanes x, Lanes z)
+{
+	LaneMask swap = int_lanes_test(hash, 4);
+	Lanes u = lanes_select(swap, z, x);
+	Lanes v = lanes_mul(lanes_select(swap, x, z), lanes_set(2.0f));
+	u = lanes_select(int_lanes_test(hash, 1), lanes_sub(lanes_set(0.0f), u), u);
+	v = lanes_select(int_lanes_test(hash, 2), lanes_sub(lanes_set(0.0f), v), v);
+	return lanes_add(u, v);
+}
+
+// 6t^5 - 15t^4 + 10t^3
+static Lanes fade(Lanes t)
+{
+	Lanes curve = lanes_add(lanes_mul(t, lanes_set(6.0f)), lanes_set(-15.0f));
+	curve = lanes_add(lanes_mul(curve, t), lanes_set(10.0f));
+	return lanes_mul(lanes_mul(lanes_mul(curve, t), t), t);
+}
+
+static Lanes lanes_lerp(Lanes a, Lanes b, Lanes t)
+{
+	return lanes_add(a, lanes_mul(t, lanes_sub(b, a)));
+}
+
+// Gradient noise in about [-1, 1]
+static Lanes noise_2d(Lanes x, Lanes z, IntLanes seed)
+{
+	Lanes cellX = lanes_floor(x);
+	Lanes cellZ = lanes_floor(z);
+	Lanes fx = lanes_sub(x, cellX);
+	Lanes fz = lanes_sub(z, cellZ);
+	IntLanes x0 = lanes_to_int(cellX);
+	IntLanes z0 = lanes_to_int(cellZ);
+	IntLanes x1 = int_lanes_add(x0, int_lanes_set(1));
+	IntLanes z1 = int_lanes_add(z0, int_lanes_set(1));
+	Lanes fx1 = lanes_sub(fx, lanes_set(1.0f));
+	Lanes fz1 = lanes_sub(fz, lanes_set(1.0f));
+
+	Lanes u = fade(fx);
+	Lanes nearRow = lanes_lerp(gradient_2d(hash_lattice(x0, z0, seed), fx, fz), gradient_2d(hash_lattice(x1, z0, seed), fx1, fz), u);
+	Lanes farRow = lanes_lerp(gradient_2d(hash_lattice(x0, z1, seed), fx, fz1), gradient_2d(hash_lattice(x1, z1, seed), fx1, fz1), u);
+	return lanes_mul(lanes_lerp(nearRow, farRow, fade(fz)), lanes_set(0.5f));
+}
+
+void NoiseTerrainGenerator::generate_heightmap(int chunkX, int chunkZ, int heights[CHUNK_SIZE * CHUNK_SIZE]) const
+{
+	float worldX[CHUNK_SIZE];
+	for (int i = 0; i < CHUNK_SIZE; ++i) worldX[i] = (float)(i + chunkX * CHUNK_SIZE);
+
+	for (int z = 0; z < CHUNK_SIZE; ++z)
+	{
+		Lanes worldZ = lanes_set((float)(z + chunkZ * CHUNK_SIZE));
+		for (int x = 0; x < CHUNK_SIZE; x += LANE_COUNT)
+		{
+			Lanes sampleX = lanes_mul(lanes_load(worldX + x), lanes_set(frequency));
+			Lanes sampleZ = lanes_mul(worldZ, lanes_set(frequency));
+
+			// Every octave doubles the frequency and halves the amplitude
+			Lanes noise = lanes_set(0.0f);
+			float octaveAmplitude = 1.0f;
+			for (int octave = 0; octave < octaves; ++octave)
+			{
+				IntLanes octaveSeed = int_lanes_set((int32_t)(seed + octave * 0x9e3779b9u));
+				noise = lanes_add(noise, lanes_mul(noise_2d(sampleX, sampleZ, octaveSeed), lanes_set(octaveAmplitude)));
+				sampleX = lanes_mul(sampleX, lanes_set(2.0f));
+				sampleZ = lanes_mul(sampleZ, lanes_set(2.0f));
+				octaveAmplitude *= 0.5f;
+			}
+
+			// Squaring the positive side flattens the lowlands and sharpens the mountains
+			Lanes positive = lanes_max(noise, lanes_set(0.0f));
+			noise = lanes_add(noise, lanes_mul(positive, positive));
+
+			Lanes height = lanes_add(lanes_mul(noise, lanes_set(amplitude)), lanes_set(baseHeight));
+			height = lanes_min(lanes_max(height, lanes_set(1.0f)), lanes_set((float)(CHUNK_SIZE_VERTICAL - 2)));
+			int_lanes_store(heights + x + z * CHUNK_SIZE, lanes_to_int(height));
+		}
+	}
+}
+
+#pragma endregion
+
+#pragma region CAVES
+
+static IntLanes hash_lattice_3d(IntLanes x, IntLanes y, IntLanes z, IntLanes seed)
+{
+	return hash_lattice(x, int_lanes_xor(z, int_lanes_mul(y, int_lanes_set(0x5bd1e995))), seed);
+}
+
+// Dot product of (x, y, z) with one of the 12 edge gradients like (+-1, +-1, 0), picked by the hash.
+// Two hash bits pick the plane, so the yz plane comes up twice as often as the other two
+static Lanes gradient_3d(IntLanes hash, Lanes x, Lanes y, Lanes z)
+{
+	LaneMask yz = int_lanes_test(hash, 8);
+	Lanes u = lanes_select(yz, y, x);
+	Lanes v = lanes_select(yz, z, lanes_select(int_lanes_test(hash, 4), z, y));
+	u = lanes_select(int_lanes_test(hash, 1), lanes_sub(lanes_set(0.0f), u), u);
+	v = lanes_select(int_lanes_test(hash, 2), lanes_sub(lanes_set(0.0f), v), v);
+	return lanes_add(u, v);
+}
+
+// Gradient noise in about [-1, 1]
+static Lanes noise_3d(Lanes x, Lanes y, Lanes z, IntLanes seed)
+{
+	Lanes cellX = lanes_floor(x);
+	Lanes cellY = lanes_floor(y);
+	Lanes cellZ = lanes_floor(z);
+	Lanes fx = lanes_sub(x, cellX);
+	Lanes fy = lanes_sub(y, cellY);
+	Lanes fz = lanes_sub(z, cellZ);
+	IntLanes x0 = lanes_to_int(cellX);
+	IntLanes y0 = lanes_to_int(cellY);
+	IntLanes z0 = lanes_to_int(cellZ);
+	IntLanes x1 = int_lanes_add(x0, int_lanes_set(1));
+	IntLanes y1 = int_lanes_add(y0, int_lanes_set(1));
+	IntLanes z1 = int_lanes_add(z0, int_lanes_set(1));
+	Lanes fx1 = lanes_sub(fx, lanes_set(1.0f));
+	Lanes fy1 = lanes_sub(fy, lanes_set(1.0f));
+	Lanes fz1 = lanes_sub(fz, lanes_set(1.0f));
+
+	Lanes u = fade(fx);
+	Lanes v = fade(fy);
+	Lanes nearBottom = lanes_lerp(gradient_3d(hash_lattice_3d(x0, y0, z0, seed), fx, fy, fz), gradient_3d(hash_lattice_3d(x1, y0, z0, seed), fx1, fy, fz), u);
+	Lanes nearTop = lanes_lerp(gradient_3d(hash_lattice_3d(x0, y1, z0, seed), fx, fy1, fz), gradient_3d(hash_lattice_3d(x1, y1, z0, seed), fx1, fy1, fz), u);
+	Lanes farBottom = lanes_lerp(gradient_3d(hash_lattice_3d(x0, y0, z1, seed), fx, fy, fz1), gradient_3d(hash_lattice_3d(x1, y0, z1, seed), fx1, fy, fz1), u);
+	Lanes farTop = lanes_lerp(gradient_3d(hash_lattice_3d(x0, y1, z1, seed), fx, fy1, fz1), gradient_3d(hash_lattice_3d(x1, y1, z1, seed), fx1, fy1, fz1), u);
+	Lanes nearRow = lanes_lerp(nearBottom, nearTop, v);
+	Lanes farRow = lanes_lerp(farBottom, farTop, v);
+	return lanes_lerp(nearRow, farRow, fade(fz));
+}
+
+void CaveGenerator::generate_density(int chunkX, int chunkZ, int top, CaveDensity& density) const
+{
+	const int CORNERS = CAVE_CELLS + 1;
+	int cellTop = std::clamp((top + CAVE_CELL_HEIGHT - 1) / CAVE_CELL_HEIGHT, 0, CAVE_CELLS_VERTICAL);
+
+	float cornerY[CAVE_LATTICE_HEIGHT];
+	for (int y = 0; y < CAVE_LATTICE_HEIGHT; ++y) cornerY[y] = (float)(y * CAVE_CELL_HEIGHT) * verticalFrequency;
+
+	// Each column of corners is sampled bottom to top in lanes, up to the top corners of the last cell
+	for (int corner = 0; corner < CORNERS * CORNERS; ++corner)
+	{
+		Lanes x = lanes_set((float)(chunkX * CHUNK_SIZE + (corner % CORNERS) * CAVE_CELL_WIDTH) * frequency);
+		Lanes z = lanes_set((float)(chunkZ * CHUNK_SIZE + (corner / CORNERS) * CAVE_CELL_WIDTH) * frequency);
+		for (int y = 0; y <= cellTop; y += LANE_COUNT)
+		{
+			Lanes sampleY = lanes_load(cornerY + y);
+			Lanes noise = noise_3d(x, sampleY, z, int_lanes_set((int32_t)seed));
+			Lanes detail = noise_3d(lanes_mul(x, lanes_set(2.0f)), lanes_mul(sampleY, lanes_set(2.0f)), lanes_mul(z, lanes_set(2.0f)), int_lanes_set((int32_t)(seed + 0x9e3779b9u)));
+			noise = lanes_add(noise, lanes_mul(detail, lanes_set(0.5f)));
+			lanes_store(density.lattice[corner] + y, lanes_sub(noise, lanes_set(threshold)));
+		}
+	}
+
+	// Interpolated values never leave the range of the corners, so cells with all corners on one side are settled here
+	for (int cellZ = 0; cellZ < CAVE_CELLS; ++cellZ)
+	{
+		for (int cellX = 0; cellX < CAVE_CELLS; ++cellX)
+		{
+			const float* corners[4] = {
+				density.lattice[cellX + cellZ * CORNERS], density.lattice[cellX + 1 + cellZ * CORNERS],
+				density.lattice[cellX + (cellZ + 1) * CORNERS], density.lattice[cellX + 1 + (cellZ + 1) * CORNERS] };
+			CaveCellState* cells = density.cells[cellX + cellZ * CAVE_CELLS];
+
+			std::fill(cells + cellTop, cells + CAVE_CELLS_VERTICAL, CAVE_CELL_SOLID);
+			for (int y = 0; y < cellTop; ++y)
+			{
+				float low = corners[0][y];
+				float high = low;
+				for (const float* column : corners)
+				{
+					low = std::min({ low, column[y], column[y + 1] });
+					high = std::max({ high, column[y], column[y + 1] });
+				}
+
+				if (high <= 0.0f) cells[y] = CAVE_CELL_SOLID;
+				else if (low > 0.0f) cells[y] = CAVE_CELL_OPEN;
+				else cells[y] = CAVE_CELL_MIXED;
+			}
+		}
+	}
+}
+
+bool CaveDensity::section_has_caves(int section) const
+{
+	int start = section * CHUNK_SECTION_HEIGHT / CAVE_CELL_HEIGHT;
+	int end = (section + 1) * CHUNK_SECTION_HEIGHT / CAVE_CELL_HEIGHT;
+	for (const auto& column : cells)
+	{
+		for (int y = start; y < end; ++y)
+		{
+			if (column[y] != CAVE_CELL_SOLID) return true;
+		}
+	}
+	return false;
+}
+
+void CaveDensity::carve_column(int x, int z, int bottom, int top, BlockData* column) const
+{
+	const int CORNERS = CAVE_CELLS + 1;
+	int cellX = x / CAVE_CELL_WIDTH;
+	int cellZ = z / CAVE_CELL_WIDTH;
+	float fx = (float)(x % CAVE_CELL_WIDTH) / CAVE_CELL_WIDTH;
+	float fz = (float)(z % CAVE_CELL_WIDTH) / CAVE_CELL_WIDTH;
+	const float* nearLeft = lattice[cellX + cellZ * CORNERS];
+	const float* nearRight = lattice[cellX + 1 + cellZ * CORNERS];
+	const float* farLeft = lattice[cellX + (cellZ + 1) * CORNERS];
+	const float* farRight = lattice[cellX + 1 + (cellZ + 1) * CORNERS];
+	const CaveCellState* cellColumn = cells[cellX + cellZ * CAVE_CELLS];
+
+	auto bilinear = [&](int y)
+	{
+		float nearValue = nearLeft[y] + (nearRight[y] - nearLeft[y]) * fx;
+		float farValue = farLeft[y] + (farRight[y] - farLeft[y]) * fx;
+		return nearValue + (farValue - nearValue) * fz;
+	};
+
+	for (int cellY = std::max(bottom, 0) / CAVE_CELL_HEIGHT; cellY * CAVE_CELL_HEIGHT < top && cellY < CAVE_CELLS_VERTICAL; ++cellY)
+	{
+		if (cellColumn[cellY] == CAVE_CELL_SOLID) continue;
+
+		int start = std::max(bottom, cellY * CAVE_CELL_HEIGHT);
+		int end = std::min(top, (cellY + 1) * CAVE_CELL_HEIGHT);
+		if (cellColumn[cellY] == CAVE_CELL_OPEN)
+		{
+			std::fill(column + start, column + end, AIR_BLOCK);
+			continue;
+		}
+
+		// Bilinear on the bottom and top faces of the cell, then linear up the column
+		float low = bilinear(cellY);
+		float high = bilinear(cellY + 1);
+		for (int y = start; y < end; ++y)
+		{
+			float t = (float)(y - cellY * CAVE_CELL_HEIGHT) / CAVE_CELL_HEIGHT;
+			if (low + (high - low) * t > 0.0f) column[y] = AIR_BLOCK;
+		}
+	}
+}
+
+CaveGenerator* create_cave_generator(uint64_t seed)
+{
+	CaveGenerator* generator = new CaveGenerator();
+	generator->seed = (uint32_t)(seed ^ (seed >> 32)) ^ 0x68e31da4u;
+	return generator;
+}
+
+#pragma endregion
+
+TerrainGenerator* create_terrain_generator(TerrainType type, uint64_t seed)
+{
+	if (type == SINE_TERRAIN) return new SineTerrainGenerator();
+
+	NoiseTerrainGenerator* generator = new NoiseTerrainGenerator();
+	generator->seed = (uint32_t)(seed ^ (seed >> 32));
+	return generator;
+}
+
+#pragma region BIOMES
+
+Biome ChunkClimate::get_biome(int x, int z, int height) const
+{
+	int sampleX = x / BIOME_SAMPLE_SPACING;
+	int sampleZ = z / BIOME_SAMPLE_SPACING;
+	float fx = (float)(x % BIOME_SAMPLE_SPACING) / BIOME_SAMPLE_SPACING;
+	float fz = (float)(z % BIOME_SAMPLE_SPACING) / BIOME_SAMPLE_SPACING;
+	const Climate& nearLeft = samples[sampleX + sampleZ * BIOME_CHUNK_SAMPLES];
+	const Climate& nearRight = samples[sampleX + 1 + sampleZ * BIOME_CHUNK_SAMPLES];
+	const Climate& farLeft = samples[sampleX + (sampleZ + 1) * BIOME_CHUNK_SAMPLES];
+	const Climate& farRight = samples[sampleX + 1 + (sampleZ + 1) * BIOME_CHUNK_SAMPLES];
+
+	auto bilinear = [&](float Climate::* value)
+	{
+		float nearValue = nearLeft.*value + (nearRight.*value - nearLeft.*value) * fx;
+		float farValue = farLeft.*value + (farRight.*value - farLeft.*value) * fx;
+		return nearValue + (farValue - nearValue) * fz;
+	};
+
+	float temperature = bilinear(&Climate::temperature) - (float)std::max(height - 64, 0) / 200.0f;
+	if (temperature < -0.3f) return SNOW_BIOME;
+	if (temperature > 0.05f && bilinear(&Climate::humidity) < 0.0f) return DESERT_BIOME;
+	return PLAINS_BIOME;
+}
+
+BiomeMap::~BiomeMap()
+{
+	for (Region* region : regions) delete region;
+}
+
+static int floor_divide(int value, int divisor)
+{
+	return value >= 0 ? value / divisor : (value + 1) / divisor - 1;
+}
+
+void BiomeMap::get_chunk_climate(int chunkX, int chunkZ, ChunkClimate& climate)
+{
+	int regionX = floor_divide(chunkX, BIOME_REGION_CHUNKS);
+	int regionZ = floor_divide(chunkZ, BIOME_REGION_CHUNKS);
+
+	auto find_region = [&]() -> Region*
+	{
+		for (Region* region : regions)
+		{
+			if (region->x == regionX && region->z == regionZ) return region;
+		}
+		return nullptr;
+	};
+
+	// Copied out while locked, so the region can be dropped as soon as the lock is released
+	auto copy_samples = [&](Region* region)
+	{
+		region->lastUse = ++lastUse;
+		int startX = (chunkX - regionX * BIOME_REGION_CHUNKS) * (CHUNK_SIZE / BIOME_SAMPLE_SPACING);
+		int startZ = (chunkZ - regionZ * BIOME_REGION_CHUNKS) * (CHUNK_SIZE / BIOME_SAMPLE_SPACING);
+		for (int z = 0; z < BIOME_CHUNK_SAMPLES; ++z)
+		{
+			const Climate* row = region->samples + startX + (startZ + z) * BIOME_REGION_SAMPLES;
+			std::copy(row, row + BIOME_CHUNK_SAMPLES, climate.samples + z * BIOME_CHUNK_SAMPLES);
+		}
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (Region* region = find_region())
+		{
+			copy_samples(region);
+			return;
+		}
+	}
+
+	// Generated without holding the lock so the other workers can carry on. Two workers can end up
+	// generating the same region, they get the same samples so the second one is just dropped
+	Region* region = new Region();
+	region->x = regionX;
+	region->z = regionZ;
+	generate_region(*region);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (Region* existing = find_region())
+	{
+		delete region;
+		region = existing;
+	}
+	else if (regions.size() >= maxRegions)
+	{
+		auto oldest = std::min_element(regions.begin(), regions.end(), [](Region* a, Region* b) { return a->lastUse < b->lastUse; });
+		delete *oldest;
+		*oldest = region;
+	}
+	else regions.push_back(region);
+
+	copy_samples(region);
+}
+
+void BiomeMap::generate_region(Region& region) const
+{
+	// Rows are padded to whole lanes
+	const int ROW_LENGTH = (BIOME_REGION_SAMPLES + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+	float sampleX[ROW_LENGTH];
+	float temperature[ROW_LENGTH];
+	float humidity[ROW_LENGTH];
+
+	int originX = region.x * BIOME_REGION_CHUNKS * CHUNK_SIZE;
+	int originZ = region.z * BIOME_REGION_CHUNKS * CHUNK_SIZE;
+	for (int x = 0; x < ROW_LENGTH; ++x) sampleX[x] = (float)(originX + x * BIOME_SAMPLE_SPACING) * frequency;
+
+	IntLanes temperatureSeed = int_lanes_set((int32_t)seed);
+	IntLanes detailSeed = int_lanes_set((int32_t)(seed + 0x9e3779b9u));
+	IntLanes humiditySeed = int_lanes_set((int32_t)(seed ^ 0x85ebca6bu));
+	for (int z = 0; z < BIOME_REGION_SAMPLES; ++z)
+	{
+		Lanes sampleZ = lanes_set((float)(originZ + z * BIOME_SAMPLE_SPACING) * frequency);
+		for (int x = 0; x < ROW_LENGTH; x += LANE_COUNT)
+		{
+			Lanes sample = lanes_load(sampleX + x);
+			Lanes detail = noise_2d(lanes_mul(sample, lanes_set(4.0f)), lanes_mul(sampleZ, lanes_set(4.0f)), detailSeed);
+			lanes_store(temperature + x, lanes_add(noise_2d(sample, sampleZ, temperatureSeed), lanes_mul(detail, lanes_set(0.25f))));
+			lanes_store(humidity + x, noise_2d(sample, sampleZ, humiditySeed));
+		}
+
+		for (int x = 0; x < BIOME_REGION_SAMPLES; ++x)
+		{
+			region.samples[x + z * BIOME_REGION_SAMPLES].temperature = temperature[x];
+			region.samples[x + z * BIOME_REGION_SAMPLES].humidity = humidity[x];
+		}
+	}
+}
+
+BiomeMap* create_biome_map(uint64_t seed)
+{
+	BiomeMap* biomeMap = new BiomeMap();
+	biomeMap->seed = (uint32_t)(seed ^ (seed >> 32)) ^ 0x3c6ef372u;
+	return biomeMap;
+}
+
+#pragma endregion
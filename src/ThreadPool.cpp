@@ -0,0 +1,73 @@
+#include "ThreadPool.h"
+#include "Logger.h"
+#include <algorithm>
+
+unsigned ThreadPool::default_worker_count()
+{
+	unsigned cores = std::thread::hardware_concurrency();
+	return std::max(1u, cores > 1 ? cores - 1 : 1u);
+}
+
+void ThreadPool::start(unsigned workerCount)
+{
+	perm_assert_msg(workers.empty(), "Thread pool was started twice");
+
+	stopping = false;
+	workers.reserve(workerCount);
+	for (unsigned i = 0; i < workerCount; ++i)
+	{
+		workers.emplace_back([this, i]()
+		{
+			while (true)
+			{
+				std::function<void(unsigned)> job;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+					if (jobs.empty()) return; // Only reached when stopping
+					job = std::move(jobs.front());
+					jobs.pop_front();
+				}
+				job(i);
+			}
+		});
+	}
+	Log_info << "Started " << workerCount << " worker threads\n";
+}
+
+void ThreadPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+
+	for (std::thread& worker : workers) worker.join();
+	workers.clear();
+}
+
+void ThreadPool::submit(std::function<void(unsigned workerIndex)> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	jobAvailable.notify_one();
+}
+
+bool ThreadPool::is_running() const
+{
+	return !workers.empty();
+}
+
+unsigned ThreadPool::worker_count() const
+{
+	return (unsigned)workers.size();
+}
+
+size_t ThreadPool::queued_jobs()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return jobs.size();
+}
@@ -1,13 +1,24 @@
 #include "gameData.h"
+#include "MeshBuilder.h"
+#include "Random.h"
+#include "TerrainGenerator.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "Logger.h"
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <cstdlib>
 
 #pragma region RENDERING
 
+// Chunks being meshed again still have their previous mesh
+static bool has_mesh(const Chunk* chunk)
+{
+	ChunkState state = chunk->get_state();
+	return state == MESHING_STATE || state == READY_STATE;
+}
+
 void World::render(const Shader& terrainShader, const Shader& waterShader, const Camera& camera)
 {
 	std::tuple<int, int> cameraPos = { camera.pos.x, camera.pos.z };
@@ -26,8 +37,9 @@ void World::render(const Shader& terrainShader, const Shader& waterShader, const
 		int x = std::get<0>(key);
 		int z = std::get<1>(key);
 
+		// Prefetched chunks past the render distance would be hidden by the fog anyway
 		Chunk* chunk = get_chunk(x, z);
-		if (chunk == nullptr) continue;
+		if (chunk == nullptr || !has_mesh(chunk) || !is_in_view_distance(x, z)) continue;
 		glm::vec3 pos = { x * CHUNK_SIZE, 0, z * CHUNK_SIZE };
 
 		glm::mat4 model = glm::mat4(1.f);
@@ -49,7 +61,7 @@ void World::render(const Shader& terrainShader, const Shader& waterShader, const
 		int z = std::get<1>(key);
 
 		Chunk* chunk = get_chunk(x, z);
-		if (chunk == nullptr) continue;
+		if (chunk == nullptr || !has_mesh(chunk) || !is_in_view_distance(x, z)) continue;
 		glm::vec3 pos = { x * CHUNK_SIZE, 0, z * CHUNK_SIZE };
 
 		glm::mat4 model = glm::mat4(1.f);
@@ -68,152 +80,768 @@ void World::render(const Shader& terrainShader, const Shader& waterShader, const
 
 #pragma region CHUNK_MANAGEMENT
 
+void ChunkGrid::reset(int minSize)
+{
+	size = 1;
+	while (size < minSize) size *= 2;
+	mask = size - 1;
+	slots.assign(size * size, Slot());
+	count = 0;
+}
+
+void ChunkGrid::insert(int x, int z, Chunk* chunk)
+{
+	Slot& slot = slot_at(x, z);
+	perm_assert_msg(slot.chunk == nullptr, "Chunk grid slot is already taken");
+	slot = { x, z, chunk };
+	count++;
+}
+
+void ChunkGrid::remove(int x, int z)
+{
+	Slot& slot = slot_at(x, z);
+	if (slot.chunk == nullptr || slot.x != x || slot.z != z) return;
+	slot.chunk = nullptr;
+	count--;
+}
+
+// Min heap on the priority
+static bool has_lower_priority(const ChunkLoadQueue::Entry& a, const ChunkLoadQueue::Entry& b)
+{
+	return a.priority > b.priority;
+}
+
+void ChunkLoadQueue::push(int x, int z, int priority)
+{
+	if (!queued.emplace(get_key(x, z), Entry{ x, z, priority }).second) return;
+	heap.push_back({ x, z, priority });
+	std::push_heap(heap.begin(), heap.end(), has_lower_priority);
+}
+
+bool ChunkLoadQueue::pop(int& x, int& z)
+{
+	while (!heap.empty())
+	{
+		std::pop_heap(heap.begin(), heap.end(), has_lower_priority);
+		Entry entry = heap.back();
+		heap.pop_back();
+
+		// Entries of dropped positions, or from before the position got a new priority
+		auto it = queued.find(get_key(entry.x, entry.z));
+		if (it == queued.end() || it->second.priority != entry.priority) continue;
+
+		queued.erase(it);
+		x = entry.x;
+		z = entry.z;
+		return true;
+	}
+	return false;
+}
+
+void ChunkLoadQueue::clear()
+{
+	heap.clear();
+	queued.clear();
+}
+
+void ChunkLoadQueue::rebuild_heap()
+{
+	heap.clear();
+	for (const auto& [key, entry] : queued) heap.push_back(entry);
+	std::make_heap(heap.begin(), heap.end(), has_lower_priority);
+}
+
+void FrameBudget::begin_frame()
+{
+	for (int i = 0; i < FRAME_WORK_COUNT; ++i) spent[i] = 0;
+}
+
+void FrameBudget::end_frame()
+{
+	for (int i = 0; i < FRAME_WORK_COUNT; ++i) usage[i] += (spent[i] - usage[i]) * 0.1;
+}
+
+void FrameBudget::add_job_time(FrameWork work, double milliseconds)
+{
+	jobCost[work] += (milliseconds - jobCost[work]) * 0.05;
+}
+
 Chunk* World::get_chunk(int x, int z)
 {
-	auto it = chunks.find({ x, z });
-	if (it == chunks.end()) return nullptr;
-	return it->second;
+	return chunks.get(x, z);
+}
 
+void World::add_chunk(int x, int z, Chunk* chunk)
+{
+	// A chunk that went out of range but wasn't deleted yet can still hold the slot
+	ChunkGrid::Slot& slot = chunks.slot_at(x, z);
+	if (slot.chunk != nullptr) delete_chunk(slot.x, slot.z);
+
+	chunks.insert(x, z, chunk);
+	sortedChunkIndicies.push_back({ x, z });
+
+	// Link the neighbours both ways
+	chunk->left = get_chunk(x - 1, z);
+	chunk->right = get_chunk(x + 1, z);
+	chunk->front = get_chunk(x, z + 1);
+	chunk->back = get_chunk(x, z - 1);
+	if (chunk->left != nullptr) chunk->left->right = chunk;
+	if (chunk->right != nullptr) chunk->right->left = chunk;
+	if (chunk->front != nullptr) chunk->front->back = chunk;
+	if (chunk->back != nullptr) chunk->back->front = chunk;
+	mark_neighbours_dirty(x, z);
 }
 
-// TODO: Implement cubic chunks
-void World::generate_chunk_data(int chunkX, int chunkZ)
+// The border faces of the neighbours on the chunk's side, and the ambient occlusion of the diagonal ones' corner
+// column, change when it's added or removed. Only those mesh parts are built again
+void World::mark_neighbours_dirty(int x, int z)
 {
-	// Check if the chunk already exists, and return if it does
-	if (chunks.find({ chunkX, chunkZ }) != chunks.end()) return;
+	for (int dz = -1; dz <= 1; ++dz)
+	{
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			if (dx == 0 && dz == 0) continue;
+			Chunk* neighbour = get_chunk(x + dx, z + dz);
+			if (neighbour == nullptr) continue;
+
+			// The columns of the neighbour next to the chunk
+			int minX = dx < 0 ? CHUNK_SIZE - 1 : 0;
+			int maxX = dx > 0 ? 0 : CHUNK_SIZE - 1;
+			int minZ = dz < 0 ? CHUNK_SIZE - 1 : 0;
+			int maxZ = dz > 0 ? 0 : CHUNK_SIZE - 1;
+			mark_dirty(neighbour, x + dx, z + dz, get_mesh_parts(minX, minZ, maxX, maxZ));
+		}
+	}
+}
 
-	Chunk* chunk = new Chunk();
+void World::delete_chunk(int x, int z)
+{
+	sortedChunkIndicies.erase(std::remove(sortedChunkIndicies.begin(), sortedChunkIndicies.end(), std::make_tuple(x, z)), sortedChunkIndicies.end());
+
+	Chunk* chunk = get_chunk(x, z);
 	if (chunk == nullptr) return;
-	// Add a new chunk to the world and mark it as dirty
-	chunks.emplace(std::make_tuple(chunkX, chunkZ), chunk);
-	sortedChunkIndicies.push_back({ chunkX, chunkZ });
 
+	// Remove all references of this chunk from its neigbours
+	if (chunk->left != nullptr) chunk->left->right = nullptr;
+	if (chunk->right != nullptr) chunk->right->left = nullptr;
+	if (chunk->front != nullptr) chunk->front->back = nullptr;
+	if (chunk->back != nullptr) chunk->back->front = nullptr;
+
+	chunks.remove(x, z);
+	chunkPool.release(chunk);
+
+	// The border faces it covered are built, a neighbour that stays loaded would have a hole there otherwise
+	mark_neighbours_dirty(x, z);
+}
 
+// Meshing before the neighbours are populated means meshing again when their trees reach in
+bool World::is_ready_to_mesh(Chunk* chunk, int x, int z, double now)
+{
+	if (now - chunk->generatedTime >= meshWaitTime) return true;
+	for (int dz = -1; dz <= 1; ++dz)
+	{
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			if (dx == 0 && dz == 0) continue;
+			Chunk* neighbour = get_chunk(x + dx, z + dz);
+			if (neighbour == nullptr ? is_waiting_for_neighbour(x + dx, z + dz) : !neighbour->is_populated()) return false;
+		}
+	}
+	return true;
+}
 
-	// Iterate through each block in the chunk
+// A chunk is a mesh candidate from when it turns dirty until it's meshed, so it's only added once
+void World::mark_dirty(Chunk* chunk, int x, int z, uint8_t parts, uint16_t sections)
+{
+	if (parts == 0 || sections == 0) return;
+	bool wasDirty = chunk->dirtyParts != 0;
+	chunk->dirtyParts |= parts;
+	chunk->dirtySections |= sections;
+	if (!wasDirty) meshCandidates.push_back({ x, z });
+}
+
+// Matches the grid to RENDER_DISTANCE, chunks that don't fit in the new range are deleted
+void World::resize_grid()
+{
+	int minSize = 2 * (RENDER_DISTANCE + MAX_PREFETCH_DISTANCE);
+	if (chunks.size >= minSize && chunks.size < minSize * 2) return;
+
+	std::vector<ChunkGrid::Slot> loaded;
+	for (const ChunkGrid::Slot& slot : chunks.slots)
+	{
+		if (slot.chunk != nullptr) loaded.push_back(slot);
+	}
+
+	for (const ChunkGrid::Slot& slot : loaded)
+	{
+		if (!is_in_range(slot.x, slot.z)) delete_chunk(slot.x, slot.z);
+	}
+	// Don't hold on to the chunks of a larger render distance
+	chunkPool.clear();
+
+	chunks.reset(minSize);
+	for (const ChunkGrid::Slot& slot : loaded)
+	{
+		if (is_in_range(slot.x, slot.z)) chunks.insert(slot.x, slot.z, slot.chunk);
+	}
+}
+
+bool World::is_in_view_distance(int x, int z)
+{
+	return x > (-RENDER_DISTANCE + lastX) && x < (RENDER_DISTANCE + lastX) &&
+		z > (-RENDER_DISTANCE + lastZ) && z < (RENDER_DISTANCE + lastZ);
+}
+
+// The square around the player, and the one around where the player is heading
+bool World::is_in_range(int x, int z)
+{
+	if (is_in_view_distance(x, z)) return true;
+	int aheadX = lastX + prefetchX;
+	int aheadZ = lastZ + prefetchZ;
+	return x > (-RENDER_DISTANCE + aheadX) && x < (RENDER_DISTANCE + aheadX) &&
+		z > (-RENDER_DISTANCE + aheadZ) && z < (RENDER_DISTANCE + aheadZ);
+}
+
+// Closest chunks come first and, at the same distance, the ones in view. Chunks outside the view count as
+// up to about 3.5 times further away, except the ones right around the player which are always needed first
+int World::get_load_priority(int x, int z)
+{
+	int dx = x - lastX;
+	int dz = z - lastZ;
+	int distance = dx * dx + dz * dz;
+	if (distance <= 2) return distance;
+
+	// Prefetched chunks come after everything around the player
+	int priority = is_in_view_distance(x, z) ? distance : distance * 2;
+
+	float facing = glm::dot(viewDirection, glm::vec2(dx, dz)) / std::sqrt((float)distance);
+	if (facing >= viewCosine) return priority;
+	return (int)(priority * (1.0f + (viewCosine - facing) * 1.5f));
+}
+
+// Returns true when the camera turned far enough since the priorities were worked out that they should be redone
+bool World::update_view(const Camera& camera)
+{
+	// Half the horizontal field of view, widened by a bit so chunks on the edge of the view count as in it
+	float halfViewAngle = std::atan(std::tan(glm::radians(camera.fov) / 2) * ASPECT_RATIO) + glm::radians(10.0f);
+	viewCosine = std::cos(halfViewAngle);
+
+	// Any direction is as good as the last one when looking straight up or down
+	glm::vec2 direction(camera.direction.x, camera.direction.z);
+	if (glm::length(direction) < 0.01f) return false;
+	direction = glm::normalize(direction);
+
+	// About 20 degrees
+	if (glm::dot(direction, viewDirection) > 0.94f) return false;
+	viewDirection = direction;
+	return true;
+}
+
+// Returns true if the prefetched square moved
+bool World::update_prefetch(const Camera& camera)
+{
+	double now = glfwGetTime();
+	float elapsed = (float)(now - lastStateUpdate);
+	glm::vec2 position(camera.pos.x, camera.pos.z);
+	glm::vec2 moved = position - lastCameraPos;
+	lastStateUpdate = now;
+	lastCameraPos = position;
+
+	// Teleports and long stalls say nothing about the speed, otherwise it's smoothed over about a quarter of a second
+	if (firstLoad || elapsed <= 0 || elapsed > 0.5f || glm::length(moved) > CHUNK_SIZE) cameraVelocity = glm::vec2(0);
+	else cameraVelocity += (moved / elapsed - cameraVelocity) * std::min(1.0f, elapsed * 4.0f);
+
+	int x = 0;
+	int z = 0;
+	if (enablePrefetch)
+	{
+		glm::vec2 ahead = cameraVelocity * (prefetchTime / CHUNK_SIZE);
+		x = std::clamp((int)std::round(ahead.x), -MAX_PREFETCH_DISTANCE, MAX_PREFETCH_DISTANCE);
+		z = std::clamp((int)std::round(ahead.y), -MAX_PREFETCH_DISTANCE, MAX_PREFETCH_DISTANCE);
+	}
+
+	if (x == prefetchX && z == prefetchZ) return false;
+	prefetchX = x;
+	prefetchZ = z;
+	return true;
+}
+
+// Independent random decisions made about the same block
+enum GenerationRandomStream
+{
+	GROUND_RANDOM,
+	FLOWER_CHANCE_RANDOM,
+	FLOWER_TYPE_RANDOM,
+	TREE_CHANCE_RANDOM,
+	TREE_HEIGHT_RANDOM,
+	TREE_SHAPE_RANDOM,
+};
+
+// Blocks of biome ground (dirt or sand) between the surface and the stone
+const int MIN_GROUND_DEPTH = 3;
+const int MAX_GROUND_DEPTH = 5;
+
+// One in TREE_CHANCE grass blocks gets a tree
+const int TREE_CHANCE = 80;
+const int MIN_TREE_TRUNK = 4;
+const int MAX_TREE_TRUNK = 6;
+
+// TODO: Generate cubic chunks, only the mesh is split into sections and a chunk is still generated as a full column
+// Runs on the worker threads, only writes to the given chunk which isn't part of the world yet
+void World::generate_chunk_data(Chunk* chunk, int chunkX, int chunkZ)
+{
+	chunk->trees.clear();
+
+	int heights[CHUNK_SIZE * CHUNK_SIZE];
+	int minHeight = CHUNK_SIZE_VERTICAL;
+	int maxHeight = 0;
+	terrainGenerator->generate_heightmap(chunkX, chunkZ, heights);
+	for (int height : heights)
+	{
+		minHeight = std::min(minHeight, height);
+		maxHeight = std::max(maxHeight, height);
+	}
+
+	// Caves never reach above the terrain, so the density is only sampled below the highest column
+	CaveDensity caves;
+	bool hasCaves = caveGenerator != nullptr;
+	if (hasCaves) caveGenerator->generate_density(chunkX, chunkZ, maxHeight, caves);
+
+	// The surface blocks depend on the biome
+	ChunkClimate climate;
+	biomeMap->get_chunk_climate(chunkX, chunkZ, climate);
+
+	bool isFilled[CHUNK_SECTION_COUNT];
+	for (int section = 0; section < CHUNK_SECTION_COUNT; ++section)
+	{
+		int sectionStart = section * CHUNK_SECTION_HEIGHT;
+		int sectionEnd = sectionStart + CHUNK_SECTION_HEIGHT;
+		isFilled[section] = true;
+
+		// Sections that are entirely stone (below the ground layer of every column), water or air
+		// (above every column, where flowers can only sit at maxHeight) are filled without visiting their blocks
+		if (sectionEnd <= minHeight - MAX_GROUND_DEPTH && !(hasCaves && caves.section_has_caves(section))) chunk->sections[section].fill(STONE_BLOCK);
+		else if (sectionStart >= maxHeight && sectionEnd <= 64) chunk->sections[section].fill(WATER_BLOCK);
+		else if (sectionStart > maxHeight && sectionStart >= 64) chunk->sections[section].fill(AIR_BLOCK);
+		else isFilled[section] = false;
+	}
+
+	// Every column is built as runs of blocks
+	BlockData column[CHUNK_SIZE_VERTICAL];
 	for (int x = 0; x < CHUNK_SIZE; ++x)
 	{
 		for (int z = 0; z < CHUNK_SIZE; ++z)
 		{
-			// Calculate the height using a sine-based terrain generation algorithm
-			int height = std::max<float>(
-				(sin((x + chunkX * CHUNK_SIZE) / 40.0f) * 50.0f +
-					sin((z + chunkZ * CHUNK_SIZE) / 50.0f) * 60.0f +
-					sin((x + chunkX * CHUNK_SIZE) / 3.0f) * 4.0f +
-					sin((z + chunkZ * CHUNK_SIZE) / 3.0f) * 4.0f +
-					sin((x + chunkX * CHUNK_SIZE + 201) / 16.0f) * 5.0f * cos((z + chunkZ * CHUNK_SIZE + 420) / 12.0f) * 5.0f +
-					sin((x + chunkX * CHUNK_SIZE + 469) / 8.0f) * 2.0f * cos((z + chunkZ * CHUNK_SIZE + 690) / 8.0f) * 2.0f),
-				-32.0f
-			) + 64.0f; // Add an offset to the height
-
-			for (int y = 0; y < CHUNK_SIZE_VERTICAL; ++y)
+			int height = std::min(heights[x + z * CHUNK_SIZE], CHUNK_SIZE_VERTICAL - 1);
+			Biome biome = climate.get_biome(x, z, height);
+
+			// The top few blocks of the ground come from the biome, shores and sea floors are sand everywhere
+			uint32_t groundRandom = block_random(seed, chunkX, chunkZ, x, 0, z, GROUND_RANDOM);
+			int groundDepth = MIN_GROUND_DEPTH + (groundRandom & 0xffff) % (MAX_GROUND_DEPTH - MIN_GROUND_DEPTH + 1);
+			int shoreHeight = 66 + (groundRandom >> 16) % 3;
+			BlockData groundBlock = (biome == DESERT_BIOME || height < shoreHeight) ? SAND_BLOCK : DIRT_BLOCK;
+			int groundStart = std::max(height - groundDepth, 0);
+			std::fill(column, column + groundStart, STONE_BLOCK);
+			std::fill(column + groundStart, column + height, groundBlock);
+
+			// Underwater (below sea level) and above the terrain surface
+			if (height < 64) std::fill(column + height, column + 64, WATER_BLOCK);
+			std::fill(column + std::max(height, 64), column + CHUNK_SIZE_VERTICAL, AIR_BLOCK);
+
+			// Surface block above the water
+			if (height >= 64)
 			{
-				// Set block type based on height and layer
-				if (y < height) // Below the terrain surface
+				if (biome == SNOW_BIOME)
+					column[height - 1] = SNOW_BLOCK;
+				else if (groundBlock == DIRT_BLOCK)
 				{
-					unsigned int stoneHeight = rand() % 10;
-					if (y > 84 + stoneHeight)
-						chunk->set_block(DIRT_BLOCK, x, y, z);
-					else
-						chunk->set_block(STONE_BLOCK, x, y, z);
-
-					unsigned sandHeight = rand() % 3;
-					if (y >= 63 && y < 64 + 6 + sandHeight)
-						chunk->set_block(SAND_BLOCK, x, y, z);
-				}
-				else if (y < 64) // Underwater (below sea level)
-				{
-					chunk->set_block(WATER_BLOCK, x, y, z);
-				}
-				else // Above terrain surface
-				{
-					chunk->set_block(AIR_BLOCK, x, y, z);
-
-					// If the block below is dirt, set the appropriate surface block
-					if (chunk->get_block_at(x, y - 1, z) == DIRT_BLOCK)
+					column[height - 1] = GRASS_BLOCK;
+					if ((block_random(seed, chunkX, chunkZ, x, height, z, FLOWER_CHANCE_RANDOM) % 100) < 1)
 					{
-						if (y - 1 > 160)
-							chunk->set_block(SNOW_BLOCK, x, y - 1, z);
-						else
-						{
-							chunk->set_block(GRASS_BLOCK, x, y - 1, z);
-							if ((rand() % 100) < 1)
-							{
-								if (rand() % 2) chunk->set_block(RED_FLOWER, x, y, z);
-								else chunk->set_block(YELLOW_FLOWER, x, y, z);
-							}
-						}
+						if (block_random(seed, chunkX, chunkZ, x, height, z, FLOWER_TYPE_RANDOM) % 2) column[height] = RED_FLOWER;
+						else column[height] = YELLOW_FLOWER;
 					}
 				}
 			}
+
+			if (hasCaves)
+			{
+				// Columns under water keep a few blocks of sea floor so the water doesn't hang over a cave.
+				// y 0 is never carved so there's no looking out of the bottom of the world
+				caves.carve_column(x, z, 1, height < 64 ? height - 4 : height, column);
+
+				// Flowers go with the grass under them
+				if (column[height - 1] == AIR_BLOCK) column[height] = AIR_BLOCK;
+			}
+
+			// Trees can reach into the neighbours, so they're only placed when the chunk is populated
+			if (column[height - 1] == GRASS_BLOCK && column[height] == AIR_BLOCK && height + MAX_TREE_TRUNK + 1 < CHUNK_SIZE_VERTICAL &&
+				block_random(seed, chunkX, chunkZ, x, height, z, TREE_CHANCE_RANDOM) % TREE_CHANCE == 0)
+			{
+				int trunkHeight = MIN_TREE_TRUNK + block_random(seed, chunkX, chunkZ, x, height, z, TREE_HEIGHT_RANDOM) % (MAX_TREE_TRUNK - MIN_TREE_TRUNK + 1);
+				chunk->trees.push_back({ (uint8_t)x, (uint8_t)height, (uint8_t)z, (uint8_t)trunkHeight });
+			}
+
+			for (int section = 0; section < CHUNK_SECTION_COUNT; ++section)
+			{
+				if (!isFilled[section]) chunk->sections[section].set_column(x, z, column + section * CHUNK_SECTION_HEIGHT);
+			}
 		}
 	}
 
+	// Generated sections can still end up uniform, e.g. all air above low terrain
+	chunk->compact();
+
 	// Mark the chunk as dirty for future updates
-	chunk->dirty = true;
+	chunk->dirtyParts = ALL_MESH_PARTS;
+	chunk->dirtySections = ALL_MESH_SECTIONS;
+}
+
+#pragma endregion
+
+#pragma region POPULATION
+
+// Chunk coordinate of a world block coordinate, rounding down for negative coordinates too
+static int get_chunk_coordinate(int blockCoordinate)
+{
+	return (blockCoordinate >= 0 ? blockCoordinate : blockCoordinate - CHUNK_SIZE + 1) / CHUNK_SIZE;
+}
+
+// A trunk with two wide layers of leaves around its top and two narrow ones above them
+static void get_tree_edits(uint64_t seed, int chunkX, int chunkZ, const TreeFeature& tree, std::vector<BlockEdit>& edits)
+{
+	int x = chunkX * CHUNK_SIZE + tree.x;
+	int z = chunkZ * CHUNK_SIZE + tree.z;
+	int top = tree.y + tree.trunkHeight;
+
+	for (int y = top - 3; y <= top; ++y)
+	{
+		int radius = y < top - 1 ? 2 : 1;
+		for (int dz = -radius; dz <= radius; ++dz)
+		{
+			for (int dx = -radius; dx <= radius; ++dx)
+			{
+				// Corners of the narrow layers are always left out, the ones of the wide layers at random
+				bool isCorner = std::abs(dx) == radius && std::abs(dz) == radius;
+				if (isCorner && (radius == 1 || block_random(seed, chunkX, chunkZ, tree.x + dx, y, tree.z + dz, TREE_SHAPE_RANDOM) % 2)) continue;
+				edits.push_back({ x + dx, y, z + dz, LEAVES_BLOCK, false });
+			}
+		}
+	}
+
+	for (int y = tree.y; y < top; ++y) edits.push_back({ x, y, z, LOG_BLOCK, false });
+}
+
+void World::queue_block_edit(int x, int y, int z, BlockData block, bool replaceSolid)
+{
+	pendingEdits.push_back({ x, y, z, block, replaceSolid });
+}
+
+void World::apply_block_edits()
+{
+	for (const BlockEdit& edit : pendingEdits)
+	{
+		if (edit.y < 0 || edit.y >= CHUNK_SIZE_VERTICAL) continue;
+
+		// Edits for chunks that aren't loaded are dropped, populating the chunk when it's loaded again puts them back
+		int chunkX = get_chunk_coordinate(edit.x);
+		int chunkZ = get_chunk_coordinate(edit.z);
+		Chunk* chunk = get_chunk(chunkX, chunkZ);
+		if (chunk == nullptr) continue;
+
+		int x = edit.x - chunkX * CHUNK_SIZE;
+		int z = edit.z - chunkZ * CHUNK_SIZE;
+		BlockData current = chunk->get_local_block(x, edit.y, z);
+		if (current == edit.block) continue;
+
+		// Logs win over leaves, so overlapping trees come out the same whichever is placed first
+		bool isReplaceable = current == AIR_BLOCK || get_block_category(current) == TRANSPARENT || (current == LEAVES_BLOCK && edit.block == LOG_BLOCK);
+		if (!edit.replaceSolid && !isReplaceable) continue;
+
+		// The dirty bookkeeping of the edited chunk and its neighbours is all done here, they're meshed once after the
+		// whole batch. The faces and ambient occlusion of the blocks around it change, the ones over the chunk borders
+		// and the section border too
+		uint16_t sections = get_mesh_sections(edit.y - 1, edit.y + 1);
+		for (int dz = -1; dz <= 1; ++dz)
+		{
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				// The columns around the block in the coordinates of that chunk, the parts are 0 if none of them are in it
+				uint8_t parts = get_mesh_parts(x - 1 - dx * CHUNK_SIZE, z - 1 - dz * CHUNK_SIZE, x + 1 - dx * CHUNK_SIZE, z + 1 - dz * CHUNK_SIZE);
+				if (parts == 0) continue;
+				Chunk* target = (dx == 0 && dz == 0) ? chunk : get_chunk(chunkX + dx, chunkZ + dz);
+				if (target != nullptr) mark_dirty(target, chunkX + dx, chunkZ + dz, parts, sections);
+			}
+		}
+		chunk->set_block(edit.block, x, edit.y, z);
+	}
+	pendingEdits.clear();
+}
+
+// Places the trees of the chunk. Trees of populated neighbours reaching into it are placed again too,
+// the chunk might have been unloaded and generated again after they were populated
+void World::populate_chunk(Chunk* chunk, int chunkX, int chunkZ)
+{
+	for (const TreeFeature& tree : chunk->trees) get_tree_edits(seed, chunkX, chunkZ, tree, pendingEdits);
+
+	std::vector<BlockEdit> neighbourEdits;
+	for (int dz = -1; dz <= 1; ++dz)
+	{
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			Chunk* neighbour = get_chunk(chunkX + dx, chunkZ + dz);
+			if (neighbour == nullptr || neighbour == chunk || !neighbour->is_populated()) continue;
+			for (const TreeFeature& tree : neighbour->trees) get_tree_edits(seed, chunkX + dx, chunkZ + dz, tree, neighbourEdits);
+		}
+	}
+	for (const BlockEdit& edit : neighbourEdits)
+	{
+		if (get_chunk_coordinate(edit.x) == chunkX && get_chunk_coordinate(edit.z) == chunkZ) pendingEdits.push_back(edit);
+	}
+
+	// Chunks are dirty from when they're generated, it can be meshed now
+	chunk->transition(GENERATED_STATE, POPULATED_STATE);
+	chunk->dirtyParts = ALL_MESH_PARTS;
+	chunk->dirtySections = ALL_MESH_SECTIONS;
+	meshCandidates.push_back({ chunkX, chunkZ });
+}
+
+// Neighbours out of range are never loaded, so chunks on the edge of the range don't wait for them
+bool World::is_waiting_for_neighbour(int x, int z)
+{
+	return get_chunk(x, z) == nullptr && is_in_range(x, z);
+}
+
+// Populates the candidates that have all their neighbours in range, or waited for them longer than meshWaitTime.
+// The rest wait for the next frame, when a neighbour might have arrived or gone out of range
+void World::populate_chunks()
+{
+	std::sort(populationCandidates.begin(), populationCandidates.end());
+	populationCandidates.erase(std::unique(populationCandidates.begin(), populationCandidates.end()), populationCandidates.end());
+
+	double now = glfwGetTime();
+	size_t waiting = 0;
+	for (const auto& [x, z] : populationCandidates)
+	{
+		Chunk* chunk = get_chunk(x, z);
+		if (chunk == nullptr || chunk->get_state() != GENERATED_STATE) continue;
+
+		bool hasNeighbours = true;
+		for (int dz = -1; dz <= 1; ++dz)
+		{
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				if (is_waiting_for_neighbour(x + dx, z + dz)) hasNeighbours = false;
+			}
+		}
+		if (hasNeighbours || now - chunk->generatedTime >= meshWaitTime) populate_chunk(chunk, x, z);
+		else populationCandidates[waiting++] = { x, z };
+	}
+	populationCandidates.resize(waiting);
 }
 
 #pragma endregion
 
 #pragma region TERRAIN_LOADING_STUFF
 
-void World::apply_updates()
+void World::start_workers()
+{
+	if (terrainGenerator == nullptr) terrainGenerator = create_terrain_generator(terrainType, seed);
+	if (enableCaves && caveGenerator == nullptr) caveGenerator = create_cave_generator(seed);
+	if (biomeMap == nullptr) biomeMap = create_biome_map(seed);
+
+	unsigned count = std::max(1, workerCount);
+	for (unsigned i = 0; i < count; ++i) meshBuilders.push_back(new MeshBuilder());
+	workerPool.start(count);
+}
+
+void World::stop_workers()
+{
+	// Lets the workers finish what they were doing, their results are collected on the next apply_updates
+	workerPool.stop();
+	for (MeshBuilder* builder : meshBuilders) delete builder;
+	meshBuilders.clear();
+}
+
+void World::collect_finished_jobs()
 {
-	// Generate the chunk data for loaded chunks
-	// Cap the max amounts of chunks that can be generated per frame
-	unsigned i = 0;
-	while ((!chunkQueue.empty()) && i < maxChunksPerFrame)
+	std::vector<std::tuple<int, int, Chunk*>> newChunks;
+	double newGenerationTime = 0;
 	{
-		std::tuple<int, int> chunkIndex = chunkQueue.front();
-		int x = std::get<0>(chunkIndex);
-		int z = std::get<1>(chunkIndex);
+		std::lock_guard<std::mutex> lock(finishedJobsMutex);
+		newChunks.swap(generatedChunks);
+		std::swap(newGenerationTime, generationTime);
+		meshUploads.insert(meshUploads.end(), finishedMeshJobs.begin(), finishedMeshJobs.end());
+		finishedMeshJobs.clear();
+	}
 
-		auto it = std::find(chunksToDelete.begin(), chunksToDelete.end(), chunkIndex);
+	unsigned generated = 0;
+	for (auto& [x, z, chunk] : newChunks)
+	{
+		chunksInProgress.erase({ x, z });
 
-		if (it != chunksToDelete.end()) {
-			chunkQueue.pop_front();
+		// The player might have moved away while the chunk was being generated, or before it was started.
+		// If the player came back in the meantime it's queued again
+		if (chunk->get_state() != GENERATED_STATE || !is_in_range(x, z) || get_chunk(x, z) != nullptr)
+		{
+			chunkPool.release(chunk);
+			if (is_in_range(x, z) && get_chunk(x, z) == nullptr) chunkQueue.push(x, z, get_load_priority(x, z));
 			continue;
 		}
+		generated++;
+		generatedChunkCount++;
 
 		Log_debug << "Generated: " << x << ", " << z << "\n";
-		generate_chunk_data(x, z);
-		i++;
-		chunkQueue.pop_front();
+		chunk->generatedTime = glfwGetTime();
+		add_chunk(x, z, chunk);
+
+		// The chunk and its neighbours might be ready to be populated now
+		for (int dz = -1; dz <= 1; ++dz)
+		{
+			for (int dx = -1; dx <= 1; ++dx) populationCandidates.push_back({ x + dx, z + dz });
+		}
 	}
+	// Cancelled chunks weren't generated, their time doesn't count
+	if (generated > 0) frameBudget.add_job_time(GENERATION_WORK, newGenerationTime * 1000.0 / generated);
 
-	// Check if any of the generated chunks need to update their mesh
-	for (auto& chunk : chunks)
+	// The meshes over the upload budget stay in meshUploads for the next frame
+	size_t uploaded = 0;
+	while (uploaded < meshUploads.size() && frameBudget.has_time(UPLOAD_WORK))
 	{
-		int x = std::get<0>(chunk.first);
-		int z = std::get<1>(chunk.first);
+		MeshJob* job = meshUploads[uploaded++];
+		frameBudget.add_job_time(MESHING_WORK, job->buildTime * 1000.0);
 
-		Chunk* chunkObj = chunk.second;
+		// Results of chunks that were deleted, or that were meshed again since, are dropped
+		Chunk* chunk = get_chunk(job->x, job->z);
+		if (chunk != nullptr && chunk->meshJobId == job->id && chunk->transition(MESHING_STATE, READY_STATE))
+		{
+			double uploadStart = glfwGetTime();
+			chunk->upload_mesh(job->meshData);
+			frameBudget.charge(UPLOAD_WORK, (glfwGetTime() - uploadStart) * 1000.0);
 
+			chunk->meshJobId = 0;
+			totalMeshTime += job->buildTime;
+			meshedChunks++;
 
-		// Flag will be zero if the newChunk and neighbor are equal, otherwise it will be non zero
-		auto updateFlag = [](Chunk*& neighbor, int& flags, int bit, Chunk* newChunk)
-		{
-			flags |= (neighbor == nullptr) << bit;  // Store current state
-			neighbor = newChunk;                    // Update neighbor
-			flags ^= (neighbor == nullptr) << bit;  // XOR to detect changes
-		};
+			// Changed while it was being meshed
+			if (chunk->dirtyParts != 0) meshCandidates.push_back({ job->x, job->z });
+		}
+		freeMeshJobs.push_back(job);
+	}
+	meshUploads.erase(meshUploads.begin(), meshUploads.begin() + uploaded);
+}
 
+void World::schedule_mesh(Chunk* chunk, int x, int z)
+{
+	MeshJob* job = nullptr;
+	if (freeMeshJobs.empty()) job = new MeshJob();
+	else
+	{
+		job = freeMeshJobs.back();
+		freeMeshJobs.pop_back();
+	}
 
-		int changeFlags = 0;
+	job->x = x;
+	job->z = z;
+	job->id = ++lastMeshJobId;
+	job->mode = meshingMode;
 
+	// The snapshot is copied on the main thread, the mesh is built on the workers
+	double copyStart = glfwGetTime();
+	job->snapshot.copy_from(*chunk);
+	frameBudget.charge(MESHING_WORK, (glfwGetTime() - copyStart) * 1000.0 + frameBudget.jobCost[MESHING_WORK]);
 
-		// If any chunk neighbouring the current chunk is changed then regenerate the current chunk's mesh
-		updateFlag(chunkObj->left, changeFlags, 0, get_chunk(x - 1, z));
-		updateFlag(chunkObj->right, changeFlags, 1, get_chunk(x + 1, z));
-		updateFlag(chunkObj->front, changeFlags, 2, get_chunk(x, z + 1));
-		updateFlag(chunkObj->back, changeFlags, 3, get_chunk(x, z - 1));
+	// Only populated chunks and ones with a mesh are scheduled, both are changed on the main thread alone
+	if (chunk->transition(READY_STATE, MESHING_STATE)) remeshCount++;
+	else perm_assert_msg(chunk->transition(POPULATED_STATE, MESHING_STATE), "Meshing a chunk that isn't populated");
 
-		if (changeFlags != 0) {
-			chunkObj->dirty = true;
-		}
+	// Changes made after the snapshot mark the chunk dirty again, so it gets meshed once more
+	chunk->meshJobId = job->id;
+	job->parts = chunk->dirtyParts;
+	job->sections = chunk->dirtySections;
+	chunk->dirtyParts = 0;
+	chunk->dirtySections = 0;
 
-		if (chunkObj->dirty) chunkObj->generate_mesh();
+	workerPool.submit([this, job](unsigned workerIndex)
+	{
+		double meshStart = glfwGetTime();
+		meshBuilders[workerIndex]->build(job->snapshot, job->mode, job->parts, job->sections, job->meshData);
+		job->buildTime = glfwGetTime() - meshStart;
+
+		std::lock_guard<std::mutex> lock(finishedJobsMutex);
+		finishedMeshJobs.push_back(job);
+	});
+}
+
+void World::apply_updates()
+{
+	if (!workerPool.is_running()) start_workers();
+	resize_grid();
+	frameBudget.begin_frame();
+
+	collect_finished_jobs();
+
+	// Edits of all the chunks populated this frame go in one batch, so every chunk they touch is meshed once
+	populate_chunks();
+	apply_block_edits();
+
+	// Hand the chunks waiting to be loaded to the workers, as many as fit in the generation budget
+	int x, z;
+	while (frameBudget.has_time(GENERATION_WORK) && chunkQueue.pop(x, z))
+	{
+		std::tuple<int, int> chunkIndex = { x, z };
+		if (get_chunk(x, z) != nullptr || chunksInProgress.count(chunkIndex)) continue;
+
+		Chunk* chunk = chunkPool.acquire();
+		chunksInProgress[chunkIndex] = chunk;
+		workerPool.submit([this, chunk, x, z](unsigned /*workerIndex*/)
+		{
+			// Chunks evicted before their turn came aren't generated at all
+			double time = 0;
+			if (chunk->get_state() == GENERATING_STATE)
+			{
+				double generationStart = glfwGetTime();
+				generate_chunk_data(chunk, x, z);
+				time = glfwGetTime() - generationStart;
+				chunk->transition(GENERATING_STATE, GENERATED_STATE);
+			}
+
+			std::lock_guard<std::mutex> lock(finishedJobsMutex);
+			generatedChunks.push_back({ x, z, chunk });
+			generationTime += time;
+		});
+		frameBudget.charge(GENERATION_WORK, frameBudget.jobCost[GENERATION_WORK]);
+	}
+
+	// Candidates still waiting for their trees, or for the mesh in flight, are added again once they're ready.
+	// The ones waiting for their neighbours' trees are checked again every frame
+	double now = glfwGetTime();
+	size_t waiting = 0;
+	for (const auto& [x, z] : meshCandidates)
+	{
+		Chunk* chunk = get_chunk(x, z);
+		if (chunk == nullptr || chunk->dirtyParts == 0) continue;
+		ChunkState state = chunk->get_state();
+		if (state == POPULATED_STATE && !is_ready_to_mesh(chunk, x, z, now)) meshCandidates[waiting++] = { x, z };
+		else if (state == POPULATED_STATE || state == READY_STATE) meshOrder.push_back({ x, z, get_load_priority(x, z) });
 	}
+	meshCandidates.resize(waiting);
+
+	// Chunks over the meshing budget stay candidates for the next frame
+	std::sort(meshOrder.begin(), meshOrder.end(), [](const ChunkLoadQueue::Entry& a, const ChunkLoadQueue::Entry& b)
+	{
+		return std::tie(a.priority, a.x, a.z) < std::tie(b.priority, b.x, b.z);
+	});
+	meshOrder.erase(std::unique(meshOrder.begin(), meshOrder.end(), [](const ChunkLoadQueue::Entry& a, const ChunkLoadQueue::Entry& b)
+	{
+		return a.x == b.x && a.z == b.z;
+	}), meshOrder.end());
+	for (const ChunkLoadQueue::Entry& entry : meshOrder)
+	{
+		if (frameBudget.has_time(MESHING_WORK)) schedule_mesh(get_chunk(entry.x, entry.z), entry.x, entry.z);
+		else meshCandidates.push_back({ entry.x, entry.z });
+	}
+	meshOrder.clear();
 
 	// Delete chunks scheduled for deletion
 	for (const auto& key : chunksToDelete)
@@ -221,43 +849,33 @@ void World::apply_updates()
 		int x = std::get<0>(key);
 		int z = std::get<1>(key);
 
-		Chunk* chunkToBeDeleted = chunks[key];
-		if (chunkToBeDeleted == nullptr) { 
-			chunks.erase(key);
-			sortedChunkIndicies.erase(std::remove(sortedChunkIndicies.begin(), sortedChunkIndicies.end(), key), sortedChunkIndicies.end());
-			Log_debug << "Erased " << x << ", " << z << "\n";
-			continue; 
-		}
-
-		Chunk* left = chunkToBeDeleted->left;
-		Chunk* right = chunkToBeDeleted->right;
-		Chunk* front = chunkToBeDeleted->front;
-		Chunk* back = chunkToBeDeleted->back;
-
-		// Remove all references of this chunk from its neigbours
-		if (left != nullptr) left->right = nullptr;
-		if (right != nullptr) right->left = nullptr;
-		if (front != nullptr) front->back = nullptr;
-		if (back != nullptr) back->front = nullptr;
-
-		delete chunkToBeDeleted;
-		chunks.erase(key);
-		sortedChunkIndicies.erase(std::remove(sortedChunkIndicies.begin(), sortedChunkIndicies.end(), key), sortedChunkIndicies.end());
+		delete_chunk(x, z);
 		Log_debug << "Erased " << x << ", " << z << "\n";
 	}
 	chunksToDelete.clear();
+
+	frameBudget.end_frame();
 }
 
-// TODO: Implement cubic chunks
-void World::update_state(glm::vec3 currentPos)
+// TODO: Load cubic chunks, whole columns are still queued and evicted by their horizontal distance alone
+void World::update_state(const Camera& camera)
 {
-	int startX = currentPos.x / CHUNK_SIZE;
-	int startZ = currentPos.z / CHUNK_SIZE;
+	int startX = camera.pos.x / CHUNK_SIZE;
+	int startZ = camera.pos.z / CHUNK_SIZE;
+
+	resize_grid();
+	bool hasTurned = update_view(camera);
+	bool hasPrefetchMoved = update_prefetch(camera);
 
 	// If player hasn't moved between chunks
-	if (startX == lastX && startZ == lastZ)
+	if (startX == lastX && startZ == lastZ && !hasPrefetchMoved)
 	{
-		if (!firstLoad) return;
+		if (!firstLoad)
+		{
+			// Chunks that came into view go first
+			if (hasTurned) chunkQueue.reprioritize([this](int x, int z) { return get_load_priority(x, z); });
+			return;
+		}
 
 		// If this is the first time this function is called
 		sortedChunkIndicies.reserve((2 * RENDER_DISTANCE) * (2 * RENDER_DISTANCE) * 2);
@@ -267,79 +885,105 @@ void World::update_state(glm::vec3 currentPos)
 	lastX = startX;
 	lastZ = startZ;
 
-	// Schedule the chunks to be generated in a spiral order from the player
-	for (int layer = 0; layer < RENDER_DISTANCE; layer++)
+	// Queue the chunks in range that aren't loaded or being generated yet, the square around the player
+	// and the prefetched one both fit in their bounding box
+	for (int z = startZ - RENDER_DISTANCE + 1 + std::min(0, prefetchZ); z < startZ + RENDER_DISTANCE + std::max(0, prefetchZ); z++)
 	{
-		for (int z = -layer; z < layer; z++)
+		for (int x = startX - RENDER_DISTANCE + 1 + std::min(0, prefetchX); x < startX + RENDER_DISTANCE + std::max(0, prefetchX); x++)
 		{
-			for (int x = -layer; x < layer; x++)
-			{
-				if (chunks.find({ x + startX, z + startZ }) != chunks.end()) continue;
-				chunkQueue.push_back({ x + startX, z + startZ });
-			}
+			if (!is_in_range(x, z) || get_chunk(x, z) != nullptr || chunksInProgress.count({ x, z })) continue;
+			chunkQueue.push(x, z, get_load_priority(x, z));
 		}
 	}
 
+	// Queued chunks that went out of range are dropped, the rest get their distance to the new position
+	chunkQueue.reprioritize([this](int x, int z)
+	{
+		return is_in_range(x, z) ? get_load_priority(x, z) : -1;
+	});
 
-	// Schedule chunks outside render distance to be deleted
-	for (const auto& chunk : chunks)
+	// Schedule chunks outside render distance, that aren't prefetched either, to be deleted
+	for (const ChunkGrid::Slot& slot : chunks.slots)
 	{
-		int x = std::get<0>(chunk.first);
-		int z = std::get<1>(chunk.first);
+		if (slot.chunk == nullptr) continue;
+		int x = slot.x;
+		int z = slot.z;
 
-		if (x <= (-RENDER_DISTANCE + startX) || x >= (RENDER_DISTANCE + startX))
-		{
-			Log_debug << "Pushed to erase: " << x << ", " << z << "\n";
-			chunksToDelete.push_back(std::make_tuple(x, z));
-		}
-		else if (z <= (-RENDER_DISTANCE + startZ) || z >= (RENDER_DISTANCE + startZ))
+		if (!is_in_range(x, z))
 		{
+			// Chunks in the grid are past generating, and already evicted ones are scheduled already
+			bool evicted = false;
+			for (ChunkState from : { GENERATED_STATE, POPULATED_STATE, MESHING_STATE, READY_STATE })
+			{
+				if (slot.chunk->transition(from, EVICTING_STATE))
+				{
+					evicted = true;
+					break;
+				}
+			}
+			if (!evicted)
+			{
+				if (slot.chunk->get_state() != EVICTING_STATE) Log_warn << "Chunk " << x << ", " << z << " can't be evicted from state " << (int)slot.chunk->get_state() << "\n";
+				continue;
+			}
+
 			Log_debug << "Pushed to erase: " << x << ", " << z << "\n";
 			chunksToDelete.push_back(std::make_tuple(x, z));
-
 		}
 	}
 
-	for (const auto& chunkIndex : chunkQueue)
+	// Chunks the workers haven't got to yet are skipped, the ones being generated are dropped when they're done
+	for (auto& [position, chunk] : chunksInProgress)
 	{
-		int x = std::get<0>(chunkIndex);
-		int z = std::get<1>(chunkIndex);
-
-		if (x <= (-RENDER_DISTANCE + startX) || x >= (RENDER_DISTANCE + startX))
-		{
-			Log_debug << "Pushed to erase: " << x << ", " << z << "\n";
-			chunksToDelete.push_back(std::make_tuple(x, z));
-		}
-		else if (z <= (-RENDER_DISTANCE + startZ) || z >= (RENDER_DISTANCE + startZ))
-		{
-			Log_debug << "Pushed to erase: " << x << ", " << z << "\n";
-			chunksToDelete.push_back(std::make_tuple(x, z));
-		}
+		if (!is_in_range(std::get<0>(position), std::get<1>(position))) chunk->transition(GENERATING_STATE, EVICTING_STATE);
 	}
 }
 
 void World::delete_all()
 {
+	stop_workers();
+	collect_finished_jobs();
+	for (MeshJob* job : meshUploads) delete job;
+	meshUploads.clear();
+	for (MeshJob* job : freeMeshJobs) delete job;
+	freeMeshJobs.clear();
+
 	chunksToDelete.clear();
+	populationCandidates.clear();
+	pendingEdits.clear();
 
-	for (const auto& chunk : chunks)
+	for (const ChunkGrid::Slot& slot : chunks.slots)
 	{
-		int x = std::get<0>(chunk.first);
-		int z = std::get<1>(chunk.first);
-		chunksToDelete.push_back(std::make_tuple(x, z));
+		if (slot.chunk != nullptr) delete_chunk(slot.x, slot.z);
 	}
+	meshCandidates.clear();
+	chunkPool.clear();
+
+	delete terrainGenerator;
+	terrainGenerator = nullptr;
+	delete caveGenerator;
+	caveGenerator = nullptr;
+	delete biomeMap;
+	biomeMap = nullptr;
+}
 
-	for (const auto& key : chunksToDelete)
+// Counts the loaded chunks and the ones being generated by their state
+void World::count_chunk_states(size_t counts[CHUNK_STATE_COUNT])
+{
+	for (int i = 0; i < CHUNK_STATE_COUNT; ++i) counts[i] = 0;
+	for (const ChunkGrid::Slot& slot : chunks.slots)
 	{
-		int x = std::get<0>(key);
-		int z = std::get<1>(key);
-
-		Chunk* chunkToBeDeleted = chunks[key];
-
-		delete chunkToBeDeleted;
-		chunks.erase(key);
-		sortedChunkIndicies.erase(std::remove(sortedChunkIndicies.begin(), sortedChunkIndicies.end(), key), sortedChunkIndicies.end());
+		if (slot.chunk != nullptr) counts[slot.chunk->get_state()]++;
 	}
+	for (const auto& [position, chunk] : chunksInProgress) counts[chunk->get_state()]++;
+}
+
+// Drops every chunk so the world gets generated again, for when the terrain settings change
+void World::regenerate()
+{
+	delete_all();
+	chunkQueue.clear();
+	firstLoad = true;
 }
 
 #pragma endregion
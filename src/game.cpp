@@ -3,6 +3,7 @@
 #include "random"
 #include "gameData.h"
 #include <algorithm>
+#include <cstdio>
 #include <Quad.h>
 
 #include "imgui.h"
@@ -92,8 +93,6 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 
 void init(GLFWwindow* window)
 {
-	srand(20);
-
 	init_quad();
 
 	int width=0, height=0;
@@ -112,7 +111,7 @@ void init(GLFWwindow* window)
 	context->cam.turn(1200, 0);
 	context->cam.update_vectors();
 
-	context->world.update_state(context->cam.pos);
+	context->world.update_state(context->cam);
 
 	context->window = window;
 
@@ -192,7 +191,7 @@ void update(float deltaTime)
 	if ((context->world.get_chunk(chunkCoord.x, chunkCoord.y) != nullptr) && context->world.get_chunk(chunkCoord.x, chunkCoord.y)->get_block_at(blockCoord.x, blockCoord.y, blockCoord.z) == WATER_BLOCK) context->underWater = true;
 	else context->underWater = false;
 
-	context->world.update_state(context->cam.pos);
+	context->world.update_state(context->cam);
 	context->world.apply_updates();
 
 	context->screenShader.hot_reload();
@@ -236,6 +235,27 @@ void update(float deltaTime)
 	ImGui::Text("%s", context->cam.get_coords_as_string().c_str());
 	ImGui::Text("Chunk: %d, %d", chunkCoord.x, chunkCoord.y);
 	ImGui::Text("Local Block: %d, %d, %d", blockCoord.x, blockCoord.y, blockCoord.z);
+
+	size_t vertexCount = 0;
+	size_t chunkMemory = 0;
+	for (auto& slot : context->world.chunks.slots)
+	{
+		if (slot.chunk == nullptr) continue;
+		vertexCount += slot.chunk->mesh.vertices.size() + slot.chunk->waterMesh.vertices.size() + slot.chunk->transparentMesh.vertices.size();
+		chunkMemory += slot.chunk->get_memory_usage();
+	}
+	ImGui::Text("Vertices: %zu", vertexCount);
+	ImGui::Text("Chunk memory: %.1f MiB", chunkMemory / (1024.0 * 1024.0));
+	ImGui::Text("Chunks allocated: %zu (%zu pooled)", context->world.chunkPool.allocatedChunks, context->world.chunkPool.freeChunks.size());
+	ImGui::Text("Load queue: %zu (heap %zu)", context->world.chunkQueue.size(), context->world.chunkQueue.heap.size());
+	if (ImGui::CollapsingHeader("Chunk states"))
+	{
+		size_t stateCounts[CHUNK_STATE_COUNT];
+		context->world.count_chunk_states(stateCounts);
+		const char* stateNames[CHUNK_STATE_COUNT] = { "Generating", "Waiting for neighbours", "Populated", "Meshing", "Ready", "Evicting" };
+		ImGui::Text("Queued: %zu", context->world.chunkQueue.size());
+		for (int i = 0; i < CHUNK_STATE_COUNT; ++i) ImGui::Text("%s: %zu", stateNames[i], stateCounts[i]);
+	}
 	ImGui::End();
 
 	ImGui::Begin("Settings");
@@ -243,8 +263,61 @@ void update(float deltaTime)
 	ImGui::Checkbox("Fog", &context->enableFog);
 	ImGui::Text("Render Distance");
 	ImGui::SliderInt("##RenderDistance", &context->world.RENDER_DISTANCE, 2, 20);
-	ImGui::Text("Chunks Rendered Per Frame");
-	ImGui::SliderInt("##ChunksPerFrame", &context->world.maxChunksPerFrame, 1, 50);
+	// Budget sliders with the time actually used by each kind of chunk work
+	FrameBudget& frameBudget = context->world.frameBudget;
+	const char* frameWorkNames[FRAME_WORK_COUNT] = { "Generation", "Meshing", "Uploads" };
+	for (int i = 0; i < FRAME_WORK_COUNT; ++i)
+	{
+		ImGui::Text("%s Budget (ms per frame)", frameWorkNames[i]);
+		ImGui::PushID(i);
+		ImGui::SliderFloat("##Budget", &frameBudget.budgets[i], 0.1f, 16.0f, "%.1f");
+		ImGui::PopID();
+		char usageText[32];
+		snprintf(usageText, sizeof(usageText), "%.2f ms", frameBudget.usage[i]);
+		ImGui::ProgressBar((float)(frameBudget.usage[i] / frameBudget.budgets[i]), ImVec2(-1, 0), usageText);
+	}
+	ImGui::Checkbox("Prefetch While Moving", &context->world.enablePrefetch);
+	ImGui::Text("Worker Threads");
+	int workerCount = context->world.workerCount;
+	if (ImGui::SliderInt("##WorkerThreads", &workerCount, 1, std::max(1u, std::thread::hardware_concurrency())))
+	{
+		context->world.stop_workers();
+		context->world.workerCount = workerCount;
+		context->world.start_workers();
+	}
+	ImGui::Text("Terrain");
+	const char* terrainTypes[TERRAIN_TYPE_COUNT] = { "Sines", "Noise" };
+	int terrainType = context->world.terrainType;
+	if (ImGui::Combo("##TerrainType", &terrainType, terrainTypes, TERRAIN_TYPE_COUNT))
+	{
+		context->world.terrainType = (TerrainType)terrainType;
+		context->world.regenerate();
+	}
+	if (ImGui::Checkbox("Caves", &context->world.enableCaves)) context->world.regenerate();
+	ImGui::Text("Meshing");
+	const char* meshingModes[MESHING_MODE_COUNT] = { "Per face", "Binary culling", "Greedy" };
+	int meshingMode = context->world.meshingMode;
+	if (ImGui::Combo("##MeshingMode", &meshingMode, meshingModes, MESHING_MODE_COUNT))
+	{
+		// Rebuild every mesh with the new mode
+		context->world.meshingMode = (MeshingMode)meshingMode;
+		context->world.totalMeshTime = 0;
+		context->world.meshedChunks = 0;
+		for (auto& slot : context->world.chunks.slots)
+		{
+			if (slot.chunk != nullptr) context->world.mark_dirty(slot.chunk, slot.x, slot.z);
+		}
+	}
+	if (context->world.meshedChunks > 0)
+	{
+		ImGui::Text("Mesh time: %.3f ms/chunk", context->world.totalMeshTime * 1000.0 / context->world.meshedChunks);
+	}
+	ImGui::Text("Max Wait For Neighbours (s)");
+	ImGui::SliderFloat("##MeshWaitTime", &context->world.meshWaitTime, 0.0f, 2.0f, "%.2f");
+	if (context->world.generatedChunkCount > 0)
+	{
+		ImGui::Text("Remeshes per generated chunk: %.3f", (double)context->world.remeshCount / context->world.generatedChunkCount);
+	}
 	ImGui::End();
 
 }
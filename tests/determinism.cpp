@@ -0,0 +1,125 @@
+#include "gameData.h"
+#include "TerrainGenerator.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Generation only depends on the seed and the chunk position, never on the order the chunks are generated in
+// or on the worker generating them. Generates the same chunks in order, shuffled, and on the world's workers,
+// and compares the blocks and trees of every chunk
+
+const int TEST_RADIUS = 6;
+
+struct GeneratedChunk
+{
+	int x;
+	int z;
+	uint64_t hash;
+};
+
+// FNV-1a over every block and tree of the chunk
+static uint64_t hash_chunk(const Chunk& chunk)
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto add = [&hash](uint64_t value)
+	{
+		hash ^= value;
+		hash *= 1099511628211ull;
+	};
+
+	for (int y = 0; y < CHUNK_SIZE_VERTICAL; ++y)
+	{
+		for (int z = 0; z < CHUNK_SIZE; ++z)
+		{
+			for (int x = 0; x < CHUNK_SIZE; ++x) add(chunk.get_local_block(x, y, z));
+		}
+	}
+	for (const TreeFeature& tree : chunk.trees) add(tree.x | (tree.y << 8) | (tree.z << 16) | ((uint64_t)tree.trunkHeight << 24));
+	return hash;
+}
+
+static void generate_sequential(World& world, std::vector<GeneratedChunk>& generated)
+{
+	Chunk chunk;
+	for (GeneratedChunk& entry : generated)
+	{
+		world.generate_chunk_data(&chunk, entry.x, entry.z);
+		entry.hash = hash_chunk(chunk);
+	}
+}
+
+// Every job gets its own chunk, so the workers only share the generators
+static void generate_on_workers(World& world, std::vector<GeneratedChunk>& generated)
+{
+	world.workerPool.start(world.workerCount);
+	for (GeneratedChunk& entry : generated)
+	{
+		world.workerPool.submit([&world, &entry](unsigned /*workerIndex*/)
+		{
+			Chunk chunk;
+			world.generate_chunk_data(&chunk, entry.x, entry.z);
+			entry.hash = hash_chunk(chunk);
+		});
+	}
+	world.workerPool.stop();
+}
+
+// Returns the number of chunks whose hash differs from the reference
+static int compare(const char* name, std::vector<GeneratedChunk> generated, const std::vector<GeneratedChunk>& reference)
+{
+	auto byPosition = [](const GeneratedChunk& a, const GeneratedChunk& b) { return std::tie(a.x, a.z) < std::tie(b.x, b.z); };
+	std::sort(generated.begin(), generated.end(), byPosition);
+
+	int mismatches = 0;
+	for (size_t i = 0; i < reference.size(); ++i)
+	{
+		if (generated[i].hash == reference[i].hash) continue;
+		std::printf("%s: chunk %d, %d differs\n", name, generated[i].x, generated[i].z);
+		mismatches++;
+	}
+	return mismatches;
+}
+
+static int test_terrain(TerrainType terrainType, bool enableCaves)
+{
+	World world;
+	world.terrainType = terrainType;
+	world.enableCaves = enableCaves;
+	world.workerCount = 4;
+	world.terrainGenerator = create_terrain_generator(world.terrainType, world.seed);
+	if (world.enableCaves) world.caveGenerator = create_cave_generator(world.seed);
+	world.biomeMap = create_biome_map(world.seed);
+
+	std::vector<GeneratedChunk> reference;
+	for (int x = -TEST_RADIUS; x < TEST_RADIUS; ++x)
+	{
+		for (int z = -TEST_RADIUS; z < TEST_RADIUS; ++z) reference.push_back({ x, z, 0 });
+	}
+	generate_sequential(world, reference);
+
+	int mismatches = 0;
+	std::vector<GeneratedChunk> shuffled = reference;
+	std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+	generate_sequential(world, shuffled);
+	mismatches += compare("Shuffled", shuffled, reference);
+
+	std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(2));
+	generate_on_workers(world, shuffled);
+	mismatches += compare("Workers", shuffled, reference);
+
+	std::printf("Terrain %d, caves %d: %zu chunks, %d mismatches\n", (int)terrainType, (int)enableCaves, reference.size(), mismatches);
+	world.delete_all();
+	return mismatches;
+}
+
+int main()
+{
+	int mismatches = 0;
+	for (int terrainType = 0; terrainType < TERRAIN_TYPE_COUNT; ++terrainType)
+	{
+		mismatches += test_terrain((TerrainType)terrainType, false);
+	}
+	mismatches += test_terrain(NOISE_TERRAIN, true);
+	return mismatches == 0 ? 0 : 1;
+}
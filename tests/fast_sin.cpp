@@ -0,0 +1,41 @@
+#include "TerrainGenerator.h"
+#include <cmath>
+#include <cstdio>
+
+// fast_sin against std::sin for every angle the sine terrain evaluates, from the world positions of chunks up to
+// 4096 chunks out. The cos terms go through the same sin with pi/2 added to the angle
+
+const int TEST_BLOCK_RANGE = 65536;
+const double MAX_ERROR = 4e-7;
+
+// The offset and period of every term of SineTerrainGenerator::generate_heightmap
+struct SineTerm
+{
+	float offset;
+	float period;
+};
+
+const SineTerm SINE_TERMS[] = { { 0, 40.0f }, { 0, 3.0f }, { 0, 50.0f }, { 201, 16.0f }, { 420, 12.0f }, { 469, 8.0f }, { 690, 8.0f } };
+
+int main()
+{
+	double maxError = 0;
+	float worstAngle = 0;
+	for (int position = -TEST_BLOCK_RANGE; position <= TEST_BLOCK_RANGE; ++position)
+	{
+		for (const SineTerm& term : SINE_TERMS)
+		{
+			float angle = ((float)position + term.offset) / term.period;
+			for (float shifted : { angle, angle + 3.14159265358979f / 2 })
+			{
+				double error = std::fabs((double)fast_sin(shifted) - std::sin((double)shifted));
+				if (error <= maxError) continue;
+				maxError = error;
+				worstAngle = shifted;
+			}
+		}
+	}
+
+	std::printf("Max error %g at %g, allowed %g\n", maxError, worstAngle, MAX_ERROR);
+	return maxError < MAX_ERROR ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#include "TerrainGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// The SIMD sine terrain against the per column formula it replaced, over 128x128 chunks around the origin.
+// fast_sin isn't exactly std::sin, so a height that lands right on a whole block can round the other way,
+// but no column may be off by more than a block
+
+const int TEST_RADIUS = 64;
+const int MAX_DIFFERENCE = 1;
+
+// The heightmap as it was computed before, 8 sines and cosines for every column
+static int get_reference_height(int worldX, int worldZ)
+{
+	float x = (float)worldX;
+	float z = (float)worldZ;
+	float height = std::sin(x / 40.0f) * 50.0f + std::sin(z / 50.0f) * 60.0f +
+		std::sin(x / 3.0f) * 4.0f + std::sin(z / 3.0f) * 4.0f +
+		std::sin((x + 201) / 16.0f) * 5.0f * std::cos((z + 420) / 12.0f) * 5.0f +
+		std::sin((x + 469) / 8.0f) * 2.0f * std::cos((z + 690) / 8.0f) * 2.0f;
+	return (int)(std::max(height, -32.0f) + 64.0f);
+}
+
+int main()
+{
+	SineTerrainGenerator generator;
+	int heights[CHUNK_SIZE * CHUNK_SIZE];
+	long long columns = 0;
+	long long different = 0;
+	int maxDifference = 0;
+	for (int chunkZ = -TEST_RADIUS; chunkZ < TEST_RADIUS; ++chunkZ)
+	{
+		for (int chunkX = -TEST_RADIUS; chunkX < TEST_RADIUS; ++chunkX)
+		{
+			generator.generate_heightmap(chunkX, chunkZ, heights);
+			for (int z = 0; z < CHUNK_SIZE; ++z)
+			{
+				for (int x = 0; x < CHUNK_SIZE; ++x)
+				{
+					int worldX = x + chunkX * CHUNK_SIZE;
+					int worldZ = z + chunkZ * CHUNK_SIZE;
+					int difference = std::abs(heights[x + z * CHUNK_SIZE] - get_reference_height(worldX, worldZ));
+					if (difference > MAX_DIFFERENCE) std::printf("Column %d, %d is %d blocks off\n", worldX, worldZ, difference);
+					maxDifference = std::max(maxDifference, difference);
+					different += difference != 0;
+					columns++;
+				}
+			}
+		}
+	}
+
+	std::printf("%lld columns, %lld differ from the formula, by %d blocks at most\n", columns, different, maxDifference);
+	return maxDifference <= MAX_DIFFERENCE ? 0 : 1;
+}